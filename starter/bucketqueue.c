@@ -0,0 +1,154 @@
+/*
+ * Our bucket queue (Dial's algorithm) implementation.
+ */
+
+#include "bucketqueue.h"
+
+#define NOTHING -1
+
+/*************************************************************************
+ ** Helper functions
+ *************************************************************************/
+
+/* Returns the bucket that holds nodes with priority 'priority' in bucket
+ * queue 'queue'.
+ */
+int bucketOf(BucketQueue* queue, int priority){
+  return priority % queue->numBuckets;
+}
+
+/* Links the node with ID 'id' and priority 'priority' in at the front of
+ * its bucket in 'queue'.
+ */
+void linkNode(BucketQueue* queue, int priority, int id){
+  int bucket = bucketOf(queue, priority);
+  int head = queue->heads[bucket];
+  queue->priorities[id] = priority;
+  queue->prev[id] = NOTHING;
+  queue->next[id] = head;
+  if (head != NOTHING){
+    queue->prev[head] = id;
+  }
+  queue->heads[bucket] = id;
+}
+
+/* Unlinks the node with ID 'id' from its bucket in 'queue'.
+ * Precondition: 'id' is in 'queue'
+ */
+void unlinkNode(BucketQueue* queue, int id){
+  int prev = queue->prev[id];
+  int next = queue->next[id];
+  if (prev != NOTHING){
+    queue->next[prev] = next;
+  }
+  else{
+    queue->heads[bucketOf(queue, queue->priorities[id])] = next;
+  }
+  if (next != NOTHING){
+    queue->prev[next] = prev;
+  }
+  queue->priorities[id] = NOTHING;
+}
+
+/*********************************************************************
+ * Required functions
+ ********************************************************************/
+/* Returns true iff a node with ID 'id' is in bucket queue 'queue'. */
+bool bucketContains(BucketQueue* queue, int id){
+  return queue->priorities[id] != NOTHING;
+}
+
+/* Removes and returns the node with minimum priority in bucket queue
+ * 'queue'. Ties are broken in favour of the most recently added node.
+ * Precondition: queue is non-empty
+ */
+HeapNode bucketExtractMin(BucketQueue* queue){
+  // every priority in the queue is within maxStep of minPriority, so this
+  // scans at most numBuckets buckets
+  while (queue->heads[bucketOf(queue, queue->minPriority)] == NOTHING){
+    queue->minPriority++;
+  }
+  HeapNode minNode;
+  minNode.id = queue->heads[bucketOf(queue, queue->minPriority)];
+  minNode.priority = queue->minPriority;
+  unlinkNode(queue, minNode.id);
+  queue->size--;
+  return minNode;
+}
+
+/* Inserts a new node with priority 'priority' and ID 'id' into bucket queue
+ * 'queue'.
+ * Precondition: 'id' is not in this queue
+ *               0 <= 'id' < queue->capacity
+ *               queue->minPriority <= priority <= queue->minPriority + maxStep
+ */
+void bucketInsert(BucketQueue* queue, int priority, int id){
+  linkNode(queue, priority, id);
+  queue->size++;
+}
+
+/* Sets priority of node with ID 'id' in bucket queue 'queue' to
+ * 'newPriority', if such a node exists in 'queue' and its priority is larger
+ * than 'newPriority', and returns True. Has no effect and returns False,
+ * otherwise.
+ * Precondition: newPriority >= queue->minPriority
+ */
+bool bucketDecreasePriority(BucketQueue* queue, int id, int newPriority){
+  if (id < 0 || id >= queue->capacity || !bucketContains(queue, id) ||
+      queue->priorities[id] <= newPriority){
+    return false;
+  }
+  unlinkNode(queue, id);
+  linkNode(queue, newPriority, id);
+  return true;
+}
+
+/* Returns a newly created empty bucket queue for nodes with IDs 0, 1, ...,
+ * 'capacity'-1, in which the priority of a node never exceeds the smallest
+ * priority in the queue by more than 'maxStep'. For Dijkstra's algorithm,
+ * 'maxStep' is the maximum edge weight.
+ * Precondition: capacity >= 0
+ *               maxStep >= 0
+ */
+BucketQueue* newBucketQueue(int capacity, int maxStep){
+  BucketQueue *queue = malloc(sizeof(BucketQueue));
+  queue->size = 0;
+  queue->capacity = capacity;
+  queue->numBuckets = maxStep + 1;
+  queue->minPriority = 0;
+  queue->heads = malloc(sizeof(int)*queue->numBuckets);
+  for (int i = 0; i < queue->numBuckets; i++){
+    queue->heads[i] = NOTHING;
+  }
+  queue->next = malloc(sizeof(int)*capacity);
+  queue->prev = malloc(sizeof(int)*capacity);
+  queue->priorities = malloc(sizeof(int)*capacity);
+  for (int i = 0; i < capacity; i++){
+    queue->priorities[i] = NOTHING;
+  }
+  return queue;
+}
+
+/* Removes every node from bucket queue 'queue' in time linear in its size
+ * and number of buckets, so that the queue can be reused from priority 0.
+ */
+void clearBucketQueue(BucketQueue* queue){
+  for (int b = 0; b < queue->numBuckets; b++){
+    for (int id = queue->heads[b]; id != NOTHING; id = queue->next[id]){
+      queue->priorities[id] = NOTHING;
+    }
+    queue->heads[b] = NOTHING;
+  }
+  queue->size = 0;
+  queue->minPriority = 0;
+}
+
+/* Frees all memory allocated for bucket queue 'queue'.
+ */
+void deleteBucketQueue(BucketQueue* queue){
+  free(queue->heads);
+  free(queue->next);
+  free(queue->prev);
+  free(queue->priorities);
+  free(queue);
+}
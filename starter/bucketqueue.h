@@ -0,0 +1,78 @@
+/*
+ * Header file for our bucket queue (Dial's algorithm) implementation.
+ *
+ * A bucket queue is a priority queue for small non-negative integer
+ * priorities that are extracted in non-decreasing order, as in Dijkstra's
+ * algorithm with integer edge weights. It keeps one bucket per priority
+ * value, so all operations take O(1) time, plus the time to skip empty
+ * buckets in extractMin, which is at most the largest extracted priority in
+ * total.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "minheap.h"
+
+#ifndef __BucketQueue_header
+#define __BucketQueue_header
+
+typedef struct bucket_queue {
+  int size;          // the number of nodes in this queue; 0 <= size <= capacity
+  int capacity;      // node IDs are 0, 1, ..., capacity-1
+  int numBuckets;    // maxStep+1 buckets, used circularly: bucket p %
+                     //   numBuckets holds the nodes with priority p
+  int minPriority;   // no node in this queue has a smaller priority; all
+                     //   have priority at most minPriority + maxStep
+  int* heads;        // heads[b] is the ID of the first node in bucket b
+  int* next;         // next[id] is the ID of the node after id in its bucket
+  int* prev;         // prev[id] is the ID of the node before id in its bucket
+  int* priorities;   // priorities[id] is the priority of node with ID id, or
+                     //   -1 if there is no such node in this queue
+} BucketQueue;
+
+/* Returns true iff a node with ID 'id' is in bucket queue 'queue'. */
+bool bucketContains(BucketQueue* queue, int id);
+
+/* Removes and returns the node with minimum priority in bucket queue
+ * 'queue'. Ties are broken in favour of the most recently added node.
+ * Precondition: queue is non-empty
+ */
+HeapNode bucketExtractMin(BucketQueue* queue);
+
+/* Inserts a new node with priority 'priority' and ID 'id' into bucket queue
+ * 'queue'.
+ * Precondition: 'id' is not in this queue
+ *               0 <= 'id' < queue->capacity
+ *               queue->minPriority <= priority <= queue->minPriority + maxStep
+ */
+void bucketInsert(BucketQueue* queue, int priority, int id);
+
+/* Sets priority of node with ID 'id' in bucket queue 'queue' to
+ * 'newPriority', if such a node exists in 'queue' and its priority is larger
+ * than 'newPriority', and returns True. Has no effect and returns False,
+ * otherwise.
+ * Precondition: newPriority >= queue->minPriority
+ */
+bool bucketDecreasePriority(BucketQueue* queue, int id, int newPriority);
+
+/* Returns a newly created empty bucket queue for nodes with IDs 0, 1, ...,
+ * 'capacity'-1, in which the priority of a node never exceeds the smallest
+ * priority in the queue by more than 'maxStep'. For Dijkstra's algorithm,
+ * 'maxStep' is the maximum edge weight.
+ * Precondition: capacity >= 0
+ *               maxStep >= 0
+ */
+BucketQueue* newBucketQueue(int capacity, int maxStep);
+
+/* Removes every node from bucket queue 'queue' in time linear in its size
+ * and number of buckets, so that the queue can be reused from priority 0.
+ */
+void clearBucketQueue(BucketQueue* queue);
+
+/* Frees all memory allocated for bucket queue 'queue'.
+ */
+void deleteBucketQueue(BucketQueue* queue);
+
+#endif
@@ -0,0 +1,570 @@
+/*
+ * Our contraction hierarchies.
+ */
+
+#include <limits.h>
+
+#include "contraction.h"
+#include "minheap.h"
+
+#define NOTHING -1
+#define UNREACHED INT_MAX   // distance of a vertex not reached by a search
+#define HEAP_ARITY 4
+#define WITNESS_SETTLE_LIMIT 500  // a witness search gives up (and the
+                                  //   shortcut is added) after settling
+                                  //   this many vertices
+
+typedef struct overlay_arc {  // an edge of the graph being contracted
+  int target;                 // the other end of the edge
+  int weight;                 // weight of the edge
+  int edge;                   // index of the edge in the hierarchy
+} OverlayArc;
+
+typedef struct overlay_list {  // a growable array of OverlayArcs
+  OverlayArc* arcs;
+  int size;
+  int capacity;
+} OverlayList;
+
+typedef struct ch_search {  // a Dijkstra search that can be reset cheaply
+  MinHeap* heap;      // priority queue
+  int* dist;          // dist[id] is the distance estimate of vertex id
+  int* predVertex;    // predVertex[id] is the predecessor of vertex id
+  int* predEdge;      // predEdge[id] is the hierarchy edge between them
+  int* touched;       // IDs of the vertices whose 'dist' is set
+  int numTouched;     // number of IDs in 'touched'
+} CHSearch;
+
+typedef struct contractor {  // everything needed while contracting
+  int numVertices;
+  OverlayList* out;     // out[id] are the edges leaving vertex id
+  OverlayList* in;      // in[id] are the edges entering vertex id
+  bool* contracted;     // contracted[id] is true iff vertex id is contracted
+  int* deleted;         // deleted[id] is the number of contracted
+                        //   neighbours of vertex id
+  CHEdge* edges;        // all edges and shortcuts created so far
+  int numEdges;
+  int edgesCapacity;
+  CHSearch* witness;    // workspace for witness searches
+  Edge* upArcs;         // the edges (u -- v) recorded for 'up' ...
+  int* upIds;           // ... and their indices in 'edges'
+  int numUp;
+  Edge* downArcs;       // the reversed edges (v -- u) recorded for 'down'
+  int* downIds;         // ... and their indices in 'edges'
+  int numDown;
+} Contractor;
+
+/*************************************************************************
+ ** Helper functions
+ *************************************************************************/
+
+/* Creates and returns a search workspace for 'numVertices' vertices. */
+CHSearch* newCHSearch(int numVertices){
+  CHSearch* search = malloc(sizeof(CHSearch));
+  search->heap = newHeapWithArity(numVertices, HEAP_ARITY);
+  search->dist = malloc(sizeof(int)*numVertices);
+  search->predVertex = malloc(sizeof(int)*numVertices);
+  search->predEdge = malloc(sizeof(int)*numVertices);
+  search->touched = malloc(sizeof(int)*numVertices);
+  for (int i = 0; i < numVertices; i++){
+    search->dist[i] = UNREACHED;
+  }
+  search->numTouched = 0;
+  return search;
+}
+
+/* Offers vertex 'v' the distance 'dist' via vertex 'predVertex' and
+ * hierarchy edge 'predEdge' in 'search'. Returns true iff this improved the
+ * distance estimate of 'v'.
+ */
+bool searchRelax(CHSearch* search, int v, int dist, int predVertex,
+                 int predEdge){
+  if (search->dist[v] == UNREACHED){
+    search->touched[search->numTouched++] = v;
+    insert(search->heap, dist, v);
+  }
+  else if (dist < search->dist[v]){
+    decreasePriority(search->heap, v, dist);
+  }
+  else{
+    return false;
+  }
+  search->dist[v] = dist;
+  search->predVertex[v] = predVertex;
+  search->predEdge[v] = predEdge;
+  return true;
+}
+
+/* Makes 'search' ready for the next search, in time proportional to the
+ * number of vertices the last one reached.
+ */
+void resetCHSearch(CHSearch* search){
+  while (search->heap->size > 0){
+    extractMin(search->heap);
+  }
+  for (int i = 0; i < search->numTouched; i++){
+    search->dist[search->touched[i]] = UNREACHED;
+  }
+  search->numTouched = 0;
+}
+
+/* Frees all memory allocated for 'search'. */
+void deleteCHSearch(CHSearch* search){
+  deleteHeap(search->heap);
+  free(search->dist);
+  free(search->predVertex);
+  free(search->predEdge);
+  free(search->touched);
+  free(search);
+}
+
+/* Appends a new hierarchy edge (from -- to, weight) to 'c' and returns its
+ * index. 'first' and 'second' are the edges it replaces, or NOTHING.
+ */
+int addCHEdge(Contractor* c, int from, int to, int weight, int first,
+              int second){
+  if (c->numEdges == c->edgesCapacity){
+    c->edgesCapacity = 2*c->edgesCapacity + 16;
+    c->edges = realloc(c->edges, sizeof(CHEdge)*c->edgesCapacity);
+  }
+  CHEdge* e = &c->edges[c->numEdges];
+  e->edge.fromVertex = from;
+  e->edge.toVertex = to;
+  e->edge.weight = weight;
+  e->first = first;
+  e->second = second;
+  return c->numEdges++;
+}
+
+/* Adds an edge to 'target' of weight 'weight' and hierarchy index 'edge' to
+ * 'list', unless 'list' already has an edge to 'target' that weighs no
+ * more; a heavier one is replaced.
+ */
+void addArc(OverlayList* list, int target, int weight, int edge){
+  for (int i = 0; i < list->size; i++){
+    if (list->arcs[i].target == target){
+      if (weight < list->arcs[i].weight){
+        list->arcs[i].weight = weight;
+        list->arcs[i].edge = edge;
+      }
+      return;
+    }
+  }
+  if (list->size == list->capacity){
+    list->capacity = 2*list->capacity + 4;
+    list->arcs = realloc(list->arcs, sizeof(OverlayArc)*list->capacity);
+  }
+  list->arcs[list->size].target = target;
+  list->arcs[list->size].weight = weight;
+  list->arcs[list->size].edge = edge;
+  list->size++;
+}
+
+/* Adds the edge (from -- to, weight) to the graph being contracted in 'c',
+ * if it is shorter than any edge from 'from' to 'to' that is already there.
+ * 'first' and 'second' are the edges it replaces, or NOTHING.
+ */
+void addOverlayEdge(Contractor* c, int from, int to, int weight, int first,
+                    int second){
+  OverlayList* out = &c->out[from];
+  for (int i = 0; i < out->size; i++){
+    if (out->arcs[i].target == to && out->arcs[i].weight <= weight){
+      return;
+    }
+  }
+  int edge = addCHEdge(c, from, to, weight, first, second);
+  addArc(&c->out[from], to, weight, edge);
+  addArc(&c->in[to], from, weight, edge);
+}
+
+/* Runs a Dijkstra search from vertex 'source' in the graph being contracted
+ * in 'c', without going through vertex 'avoid' or any contracted vertex,
+ * and stops once the search is 'maxDist' away from 'source' or has settled
+ * WITNESS_SETTLE_LIMIT vertices. Distances found are left in c->witness.
+ */
+void witnessSearch(Contractor* c, int source, int avoid, int maxDist){
+  CHSearch* search = c->witness;
+  searchRelax(search, source, 0, NOTHING, NOTHING);
+  int settled = 0;
+  while (search->heap->size > 0 && getMin(search->heap).priority <= maxDist &&
+         settled < WITNESS_SETTLE_LIMIT){
+    HeapNode u = extractMin(search->heap);
+    settled++;
+    OverlayList* out = &c->out[u.id];
+    for (int i = 0; i < out->size; i++){
+      int x = out->arcs[i].target;
+      if (x != avoid && !c->contracted[x]){
+        searchRelax(search, x, u.priority + out->arcs[i].weight, u.id,
+                    NOTHING);
+      }
+    }
+  }
+}
+
+/* Contracts vertex 'v' in 'c' if 'apply' is true, and only counts what
+ * contracting it would do otherwise. Returns the number of shortcuts the
+ * contraction needs: one for each pair of remaining edges u -> v -> x such
+ * that no path from u to x that avoids v is as short.
+ */
+int contractVertex(Contractor* c, int v, bool apply){
+  int numShortcuts = 0;
+  OverlayList* in = &c->in[v];
+  OverlayList* out = &c->out[v];
+  for (int i = 0; i < in->size; i++){
+    int u = in->arcs[i].target;
+    if (c->contracted[u]){
+      continue;
+    }
+    int maxDist = NOTHING;
+    for (int j = 0; j < out->size; j++){
+      int x = out->arcs[j].target;
+      int viaV = in->arcs[i].weight + out->arcs[j].weight;
+      if (x != u && !c->contracted[x] && viaV > maxDist){
+        maxDist = viaV;
+      }
+    }
+    if (maxDist == NOTHING){
+      continue;  // no edge leaves v towards a vertex other than u
+    }
+    witnessSearch(c, u, v, maxDist);
+    for (int j = 0; j < out->size; j++){
+      int x = out->arcs[j].target;
+      int viaV = in->arcs[i].weight + out->arcs[j].weight;
+      if (x != u && !c->contracted[x] && c->witness->dist[x] > viaV){
+        numShortcuts++;
+        if (apply){
+          addOverlayEdge(c, u, x, viaV, in->arcs[i].edge, out->arcs[j].edge);
+        }
+      }
+    }
+    resetCHSearch(c->witness);
+  }
+  return numShortcuts;
+}
+
+/* Returns the number of remaining edges into or out of vertex 'v' in 'c'.
+ */
+int remainingDegree(Contractor* c, int v){
+  int degree = 0;
+  for (int i = 0; i < c->in[v].size; i++){
+    if (!c->contracted[c->in[v].arcs[i].target]) degree++;
+  }
+  for (int i = 0; i < c->out[v].size; i++){
+    if (!c->contracted[c->out[v].arcs[i].target]) degree++;
+  }
+  return degree;
+}
+
+/* Returns the contraction priority of vertex 'v' in 'c': its edge
+ * difference plus its number of contracted neighbours. Vertices with lower
+ * priority are contracted first.
+ */
+int contractionPriority(Contractor* c, int v){
+  return contractVertex(c, v, false) - remainingDegree(c, v) + c->deleted[v];
+}
+
+/* Records in 'c' the edges of vertex 'v' that lead to remaining vertices,
+ * which are the edges of 'v' going up the hierarchy, before 'v' is
+ * contracted.
+ */
+void recordUpwardEdges(Contractor* c, int v){
+  OverlayList* out = &c->out[v];
+  for (int i = 0; i < out->size; i++){
+    if (!c->contracted[out->arcs[i].target]){
+      Edge arc = {v, out->arcs[i].target, out->arcs[i].weight};
+      c->upArcs[c->numUp] = arc;
+      c->upIds[c->numUp++] = out->arcs[i].edge;
+    }
+  }
+  OverlayList* in = &c->in[v];
+  for (int i = 0; i < in->size; i++){
+    if (!c->contracted[in->arcs[i].target]){
+      Edge arc = {v, in->arcs[i].target, in->arcs[i].weight};
+      c->downArcs[c->numDown] = arc;
+      c->downIds[c->numDown++] = in->arcs[i].edge;
+    }
+  }
+}
+
+/* Returns a newly created CSRGraph with 'numVertices' vertices and the
+ * 'numArcs' edges in 'arcs', and sets '*edgeIds' to a new array holding
+ * ids[i] at the position where arcs[i] ends up.
+ */
+CSRGraph* arcsToCSR(int numVertices, Edge* arcs, int* ids, int numArcs,
+                    int** edgeIds){
+  CSRGraph* csr = malloc(sizeof(CSRGraph));
+  csr->numVertices = numVertices;
+  csr->numEdges = numArcs;
+  csr->maxWeight = 0;
+  csr->image = NULL;
+  csr->imageBytes = 0;
+  csr->offsets = calloc(numVertices+1, sizeof(int));
+  csr->targets = malloc(sizeof(int)*numArcs);
+  csr->weights = malloc(sizeof(int)*numArcs);
+  *edgeIds = malloc(sizeof(int)*numArcs);
+  // counting sort by "from" vertex, as in reverseCSRGraph
+  for (int i = 0; i < numArcs; i++){
+    csr->offsets[arcs[i].fromVertex+1]++;
+  }
+  for (int v = 0; v < numVertices; v++){
+    csr->offsets[v+1] += csr->offsets[v];
+  }
+  int* next = malloc(sizeof(int)*(numVertices+1));
+  for (int v = 0; v <= numVertices; v++){
+    next[v] = csr->offsets[v];
+  }
+  for (int i = 0; i < numArcs; i++){
+    int pos = next[arcs[i].fromVertex]++;
+    csr->targets[pos] = arcs[i].toVertex;
+    csr->weights[pos] = arcs[i].weight;
+    (*edgeIds)[pos] = ids[i];
+    if (arcs[i].weight > csr->maxWeight) csr->maxWeight = arcs[i].weight;
+  }
+  free(next);
+  return csr;
+}
+
+/* Settles the next vertex of 'search', one side of a hierarchy query, and
+ * relaxes its edges in 'graph', whose i-th edge is hierarchy edge
+ * 'edgeIds'[i]. If the vertex was reached by the opposite search 'other'
+ * too, and the path through it is shorter than '*best', updates '*best'
+ * and '*meet'.
+ */
+void chStep(CSRGraph* graph, int* edgeIds, CHSearch* search, CHSearch* other,
+            int* best, int* meet){
+  HeapNode u = extractMin(search->heap);
+  if (other->dist[u.id] != UNREACHED &&
+      u.priority + other->dist[u.id] < *best){
+    *best = u.priority + other->dist[u.id];
+    *meet = u.id;
+  }
+  for (int e = graph->offsets[u.id]; e < graph->offsets[u.id+1]; e++){
+    searchRelax(search, graph->targets[e], u.priority + graph->weights[e],
+                u.id, edgeIds[e]);
+  }
+}
+
+/* Runs a query from 'source' to 'target' on 'ch' and returns the vertex at
+ * the top of a shortest path, or NOTHING if there is none. The searches are
+ * left in ch->forward and ch->backward; reset them when done.
+ */
+int chQuery(ContractionHierarchy* ch, int source, int target){
+  CHSearch* forward = ch->forward;
+  CHSearch* backward = ch->backward;
+  searchRelax(forward, source, 0, NOTHING, NOTHING);
+  searchRelax(backward, target, 0, NOTHING, NOTHING);
+
+  int best = UNREACHED;
+  int meet = NOTHING;
+  // a side is done once its frontier is at least 'best' away
+  while (true){
+    bool forwardOpen = forward->heap->size > 0 &&
+                       getMin(forward->heap).priority < best;
+    bool backwardOpen = backward->heap->size > 0 &&
+                        getMin(backward->heap).priority < best;
+    if (forwardOpen && (!backwardOpen || getMin(forward->heap).priority <=
+                                             getMin(backward->heap).priority)){
+      chStep(ch->up, ch->upEdges, forward, backward, &best, &meet);
+    }
+    else if (backwardOpen){
+      chStep(ch->down, ch->downEdges, backward, forward, &best, &meet);
+    }
+    else{
+      break;
+    }
+  }
+  return meet;
+}
+
+/* Appends the edges of the graph that hierarchy edge 'edge' of 'ch' stands
+ * for to the list that ends at '*end', and returns the new end.
+ */
+EdgeList** unpackEdge(ContractionHierarchy* ch, int edge, EdgeList** end){
+  CHEdge* e = &ch->edges[edge];
+  if (e->first == NOTHING){
+    *end = newEdgeList(newEdge(e->edge.fromVertex, e->edge.toVertex,
+                               e->edge.weight), NULL);
+    return &(*end)->next;
+  }
+  end = unpackEdge(ch, e->first, end);
+  return unpackEdge(ch, e->second, end);
+}
+
+/*********************************************************************
+ * Required functions
+ ********************************************************************/
+/* Contracts all vertices of 'graph' and returns the resulting hierarchy.
+ * Vertices are contracted in order of edge difference: the number of
+ * shortcuts their contraction adds minus the number of edges it removes,
+ * plus the number of their neighbours already contracted.
+ * Returns NULL if 'graph' is NULL.
+ */
+ContractionHierarchy* buildContractionHierarchy(CSRGraph* graph){
+  if (graph == NULL) return NULL;
+  int n = graph->numVertices;
+
+  Contractor c;
+  c.numVertices = n;
+  c.out = calloc(n, sizeof(OverlayList));
+  c.in = calloc(n, sizeof(OverlayList));
+  c.contracted = calloc(n, sizeof(bool));
+  c.deleted = calloc(n, sizeof(int));
+  c.edges = NULL;
+  c.numEdges = 0;
+  c.edgesCapacity = 0;
+  c.witness = newCHSearch(n);
+  for (int u = 0; u < n; u++){
+    for (int e = graph->offsets[u]; e < graph->offsets[u+1]; e++){
+      if (graph->targets[e] != u){  // loops never lie on a shortest path
+        addOverlayEdge(&c, u, graph->targets[e], graph->weights[e], NOTHING,
+                       NOTHING);
+      }
+    }
+  }
+  // every overlay edge is recorded once, when its lower end is contracted
+  c.upArcs = malloc(sizeof(Edge)*c.numEdges);
+  c.upIds = malloc(sizeof(int)*c.numEdges);
+  c.numUp = 0;
+  c.downArcs = malloc(sizeof(Edge)*c.numEdges);
+  c.downIds = malloc(sizeof(int)*c.numEdges);
+  c.numDown = 0;
+  int upCapacity = c.numEdges;
+
+  // initial priorities of all vertices, heapified in linear time
+  int* priorities = malloc(sizeof(int)*n);
+  int* ids = malloc(sizeof(int)*n);
+  for (int v = 0; v < n; v++){
+    priorities[v] = contractionPriority(&c, v);
+    ids[v] = v;
+  }
+  MinHeap* order = newHeapFromArray(priorities, ids, n, n, HEAP_ARITY);
+  free(priorities);
+  free(ids);
+
+  int* rank = malloc(sizeof(int)*n);
+  int nextRank = 0;
+  while (order->size > 0){
+    HeapNode node = extractMin(order);
+    int v = node.id;
+    // priorities go stale as neighbours are contracted: recompute lazily,
+    // and put 'v' back if it is no longer the minimum
+    int priority = contractionPriority(&c, v);
+    if (order->size > 0 && priority > getMin(order).priority){
+      insert(order, priority, v);
+      continue;
+    }
+    if (c.numEdges > upCapacity){
+      upCapacity = c.numEdges;
+      c.upArcs = realloc(c.upArcs, sizeof(Edge)*upCapacity);
+      c.upIds = realloc(c.upIds, sizeof(int)*upCapacity);
+      c.downArcs = realloc(c.downArcs, sizeof(Edge)*upCapacity);
+      c.downIds = realloc(c.downIds, sizeof(int)*upCapacity);
+    }
+    recordUpwardEdges(&c, v);
+    contractVertex(&c, v, true);
+    c.contracted[v] = true;
+    rank[v] = nextRank++;
+    for (int i = 0; i < c.out[v].size; i++) c.deleted[c.out[v].arcs[i].target]++;
+    for (int i = 0; i < c.in[v].size; i++) c.deleted[c.in[v].arcs[i].target]++;
+  }
+  deleteHeap(order);
+
+  ContractionHierarchy* ch = malloc(sizeof(ContractionHierarchy));
+  ch->numVertices = n;
+  ch->rank = rank;
+  ch->numEdges = c.numEdges;
+  ch->edges = c.edges;
+  ch->up = arcsToCSR(n, c.upArcs, c.upIds, c.numUp, &ch->upEdges);
+  ch->down = arcsToCSR(n, c.downArcs, c.downIds, c.numDown, &ch->downEdges);
+  ch->forward = newCHSearch(n);
+  ch->backward = newCHSearch(n);
+
+  for (int v = 0; v < n; v++){
+    free(c.out[v].arcs);
+    free(c.in[v].arcs);
+  }
+  free(c.out);
+  free(c.in);
+  free(c.contracted);
+  free(c.deleted);
+  deleteCHSearch(c.witness);
+  free(c.upArcs);
+  free(c.upIds);
+  free(c.downArcs);
+  free(c.downIds);
+  return ch;
+}
+
+/* Returns the length of a shortest path from vertex 'source' to vertex
+ * 'target' in the graph of hierarchy 'ch', or INT_MAX if there is no path.
+ * Returns -1 if 'source' or 'target' is not valid.
+ * Note: queries reuse the workspace kept in 'ch', so a hierarchy must not
+ * be queried by several threads at once.
+ */
+int getDistanceCH(ContractionHierarchy* ch, int source, int target){
+  if (source < 0 || source >= ch->numVertices ||
+      target < 0 || target >= ch->numVertices){
+    return NOTHING;
+  }
+  int meet = chQuery(ch, source, target);
+  int dist = UNREACHED;
+  if (meet != NOTHING){
+    dist = ch->forward->dist[meet] + ch->backward->dist[meet];
+  }
+  resetCHSearch(ch->forward);
+  resetCHSearch(ch->backward);
+  return dist;
+}
+
+/* Returns a shortest path from vertex 'source' to vertex 'target' in the
+ * graph of hierarchy 'ch', with all shortcuts replaced by the edges they
+ * stand for:
+ *   [(source -- id_1, w_0), (id_1 -- id_2, w_1), ..., (id_n -- target, w_n)]
+ * Returns NULL if 'source' or 'target' is not valid, if 'target' cannot be
+ * reached from 'source', or if 'source' equals 'target'.
+ * Note: see getDistanceCH.
+ */
+EdgeList* getShortestPathCH(ContractionHierarchy* ch, int source, int target){
+  if (source < 0 || source >= ch->numVertices ||
+      target < 0 || target >= ch->numVertices || source == target){
+    return NULL;
+  }
+  int meet = chQuery(ch, source, target);
+  EdgeList* path = NULL;
+  if (meet != NOTHING){
+    // the forward predecessors lead from 'meet' back to 'source': collect
+    // those edges first, then unpack them in source-to-meet order; all of
+    // them end at vertices the forward search touched
+    int* upward = malloc(sizeof(int)*ch->forward->numTouched);
+    int numUpward = 0;
+    for (int v = meet; v != source; v = ch->forward->predVertex[v]){
+      upward[numUpward++] = ch->forward->predEdge[v];
+    }
+    EdgeList** end = &path;
+    for (int i = numUpward - 1; i >= 0; i--){
+      end = unpackEdge(ch, upward[i], end);
+    }
+    free(upward);
+    for (int v = meet; v != target; v = ch->backward->predVertex[v]){
+      end = unpackEdge(ch, ch->backward->predEdge[v], end);
+    }
+  }
+  resetCHSearch(ch->forward);
+  resetCHSearch(ch->backward);
+  return path;
+}
+
+/* Frees all memory allocated for hierarchy 'ch'.
+ */
+void deleteContractionHierarchy(ContractionHierarchy* ch){
+  if (ch == NULL) return;
+  free(ch->rank);
+  free(ch->edges);
+  deleteCSRGraph(ch->up);
+  free(ch->upEdges);
+  deleteCSRGraph(ch->down);
+  free(ch->downEdges);
+  deleteCHSearch(ch->forward);
+  deleteCHSearch(ch->backward);
+  free(ch);
+}
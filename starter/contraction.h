@@ -0,0 +1,79 @@
+/*
+ * Header file for our contraction hierarchies.
+ *
+ * A contraction hierarchy answers shortest path queries on a graph that
+ * does not change. Preprocessing removes ("contracts") the vertices one at
+ * a time, least important first, and adds a shortcut edge u -> x of weight
+ * w1 + w2 for every path u -> v -> x through the contracted vertex v that
+ * no other path can replace. A query then only needs a search from the
+ * source and a search from the target that both go up the hierarchy, i.e.
+ * towards vertices contracted later; these searches are tiny even on very
+ * large graphs.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Contraction_header
+#define __Contraction_header
+
+typedef struct ch_edge {  // an edge of a contraction hierarchy
+  Edge edge;              // the edge (from -- to, weight)
+  int first;              // for a shortcut, index of the edge (from -- via)
+                          //   it replaces; -1 for an edge of the graph
+  int second;             // for a shortcut, index of the edge (via -- to)
+                          //   it replaces; -1 for an edge of the graph
+} CHEdge;
+
+typedef struct contraction_hierarchy {
+  int numVertices;   // total number of vertices
+  int* rank;         // rank[id] is the position of vertex id in the
+                     //   contraction order: 0 for the first contracted
+  int numEdges;      // number of edges in 'edges', shortcuts included
+  CHEdge* edges;     // every edge of the graph and every shortcut
+  CSRGraph* up;      // for every edge (u -- v, w) with rank[u] < rank[v],
+                     //   the edge (u -- v, w)
+  int* upEdges;      // upEdges[i] is the index in 'edges' of the i-th
+                     //   edge of 'up'
+  CSRGraph* down;    // for every edge (u -- v, w) with rank[u] > rank[v],
+                     //   the reversed edge (v -- u, w)
+  int* downEdges;    // downEdges[i] is the index in 'edges' of the i-th
+                     //   edge of 'down'
+  struct ch_search* forward;   // query workspace for the source side
+  struct ch_search* backward;  // query workspace for the target side
+} ContractionHierarchy;
+
+/* Contracts all vertices of 'graph' and returns the resulting hierarchy.
+ * Vertices are contracted in order of edge difference: the number of
+ * shortcuts their contraction adds minus the number of edges it removes,
+ * plus the number of their neighbours already contracted.
+ * Returns NULL if 'graph' is NULL.
+ */
+ContractionHierarchy* buildContractionHierarchy(CSRGraph* graph);
+
+/* Returns the length of a shortest path from vertex 'source' to vertex
+ * 'target' in the graph of hierarchy 'ch', or INT_MAX if there is no path.
+ * Returns -1 if 'source' or 'target' is not valid.
+ * Note: queries reuse the workspace kept in 'ch', so a hierarchy must not
+ * be queried by several threads at once.
+ */
+int getDistanceCH(ContractionHierarchy* ch, int source, int target);
+
+/* Returns a shortest path from vertex 'source' to vertex 'target' in the
+ * graph of hierarchy 'ch', with all shortcuts replaced by the edges they
+ * stand for:
+ *   [(source -- id_1, w_0), (id_1 -- id_2, w_1), ..., (id_n -- target, w_n)]
+ * Returns NULL if 'source' or 'target' is not valid, if 'target' cannot be
+ * reached from 'source', or if 'source' equals 'target'.
+ * Note: see getDistanceCH.
+ */
+EdgeList* getShortestPathCH(ContractionHierarchy* ch, int source, int target);
+
+/* Frees all memory allocated for hierarchy 'ch'.
+ */
+void deleteContractionHierarchy(ContractionHierarchy* ch);
+
+#endif
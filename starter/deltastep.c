@@ -0,0 +1,351 @@
+/*
+ * Our delta-stepping shortest paths.
+ */
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "deltastep.h"
+
+#define NOTHING -1
+#define UNREACHED INT_MAX  // distance of a vertex not reachable from the start
+#define RELAX_CHUNK 256  // frontier vertices a thread takes at a time
+
+typedef struct int_vector {  // a growable array of ints
+  int size;      // number of ints in 'items'
+  int capacity;  // number of ints 'items' has room for
+  int* items;    // the ints
+} IntVector;
+
+typedef struct delta_stepping {  // state shared by all threads of a search
+  CSRGraph* graph;     // the graph, read-only
+  int delta;           // width of a bucket
+  int numThreads;      // number of threads running the search
+  _Atomic uint64_t* labels;  // labels[id] holds the tentative distance of
+                             //   vertex id in its high 32 bits and the
+                             //   predecessor of id in its low 32 bits, so
+                             //   both change in one atomic step
+  int numBuckets;      // buckets are used circularly: bucket b is in
+                       //   buckets[b % numBuckets]
+  IntVector* buckets;  // bucket b holds the vertices with a tentative
+                       //   distance in [b*delta, (b+1)*delta), and vertices
+                       //   whose distance has dropped since they were added
+  int numQueued;       // number of entries in all buckets, stale included
+  int* queuedAt;       // queuedAt[id] is the distance vertex id had when it
+                       //   was last added to a bucket, or NOTHING
+  int* relaxedAt;      // relaxedAt[id] is the distance vertex id had when
+                       //   its light edges were last relaxed, or NOTHING
+  int* settledIn;      // settledIn[id] is the bucket vertex id was settled
+                       //   in, or NOTHING
+  int bucket;          // the current bucket
+  IntVector frontier;  // vertices whose light edges the current phase relaxes
+  IntVector settled;   // vertices settled in the current bucket
+  bool heavy;          // true iff the current phase relaxes the heavy edges
+                       //   of 'settled' rather than the light edges of
+                       //   'frontier'
+  bool done;           // true iff all buckets are empty
+  atomic_int nextChunk;  // index of the first vertex of the current phase
+                         //   no thread has taken yet
+  IntVector* reached;  // reached[t] holds the vertices whose distance thread
+                       //   t lowered in the current phase
+  pthread_mutex_t startLock;  // held until every thread has been started
+  pthread_barrier_t barrier;  // separates the phases
+} DeltaStepping;
+
+typedef struct delta_worker {  // one thread of a search
+  DeltaStepping* search;  // the search this thread helps with
+  int index;              // 0 for the calling thread, which also plans and
+                          //   merges the phases
+} DeltaWorker;
+
+/*************************************************************************
+ ** Helper functions
+ *************************************************************************/
+
+/* Appends 'item' to 'vector', growing it if needed. */
+void pushBack(IntVector* vector, int item){
+  if (vector->size == vector->capacity){
+    vector->capacity = vector->capacity > 0 ? 2*vector->capacity : 16;
+    vector->items = realloc(vector->items, sizeof(int)*vector->capacity);
+  }
+  vector->items[vector->size++] = item;
+}
+
+/* Returns the label of a vertex at distance 'distance' via 'predId'. */
+uint64_t packLabel(int distance, int predId){
+  return ((uint64_t)(uint32_t)distance << 32) | (uint32_t)predId;
+}
+
+/* Returns the tentative distance of vertex 'v' in 'search'. */
+int distanceOf(DeltaStepping* search, int v){
+  uint64_t label = atomic_load_explicit(&search->labels[v],
+                                        memory_order_relaxed);
+  return (int)(label >> 32);
+}
+
+/* Adds vertex 'v' to the bucket of its tentative distance in 'search',
+ * unless it is there already with that distance.
+ */
+void enqueueVertex(DeltaStepping* search, int v){
+  int distance = distanceOf(search, v);
+  if (search->queuedAt[v] == distance){
+    return;
+  }
+  search->queuedAt[v] = distance;
+  int b = distance/search->delta;
+  pushBack(&search->buckets[b % search->numBuckets], v);
+  search->numQueued++;
+}
+
+/* Relaxes the light edges of vertex 'u' in 'search', or its heavy edges if
+ * the current phase is heavy, and appends every vertex whose distance it
+ * lowers to 'reached'.
+ */
+void relaxEdges(DeltaStepping* search, int u, IntVector* reached){
+  CSRGraph* graph = search->graph;
+  int distU = distanceOf(search, u);
+  for (int e = graph->offsets[u]; e < graph->offsets[u+1]; e++){
+    int weight = graph->weights[e];
+    if ((weight > search->delta) != search->heavy){
+      continue;
+    }
+    int v = graph->targets[e];
+    int d = distU + weight;
+    uint64_t label = atomic_load_explicit(&search->labels[v],
+                                          memory_order_relaxed);
+    // on failure, 'label' is reloaded: retry while d still improves on it
+    while ((int)(label >> 32) > d){
+      if (atomic_compare_exchange_weak_explicit(&search->labels[v], &label,
+                                                packLabel(d, u),
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)){
+        pushBack(reached, v);
+        break;
+      }
+    }
+  }
+}
+
+/* Moves the entries of the current bucket of 'search' whose light edges need
+ * relaxing into the frontier, and records them as settled in this bucket.
+ */
+void takeBucket(DeltaStepping* search){
+  IntVector* slot = &search->buckets[search->bucket % search->numBuckets];
+  search->frontier.size = 0;
+  for (int i = 0; i < slot->size; i++){
+    int v = slot->items[i];
+    int distance = distanceOf(search, v);
+    search->numQueued--;
+    if (distance/search->delta != search->bucket ||
+        search->relaxedAt[v] == distance){
+      continue;  // stale: v has moved to a lower bucket, or is done here
+    }
+    search->relaxedAt[v] = distance;
+    pushBack(&search->frontier, v);
+    if (search->settledIn[v] != search->bucket){
+      search->settledIn[v] = search->bucket;
+      pushBack(&search->settled, v);
+    }
+  }
+  slot->size = 0;
+}
+
+/* Sets up the next phase of 'search': another round of light edges from the
+ * current bucket if it is not empty yet, else the heavy edges of all
+ * vertices settled in it, else the light edges of the next non-empty bucket.
+ * Sets 'done' if there is none.
+ */
+void planPhase(DeltaStepping* search){
+  atomic_store(&search->nextChunk, 0);
+  while (true){
+    if (!search->heavy){
+      takeBucket(search);
+      if (search->frontier.size > 0){
+        return;
+      }
+      if (search->settled.size > 0){
+        search->heavy = true;
+        return;
+      }
+    }
+    search->heavy = false;
+    search->settled.size = 0;
+    if (search->numQueued == 0){
+      search->done = true;
+      return;
+    }
+    search->bucket++;
+  }
+}
+
+/* Adds every vertex reached by any thread in the last phase of 'search' to
+ * the bucket of its new distance.
+ */
+void mergeReached(DeltaStepping* search){
+  for (int t = 0; t < search->numThreads; t++){
+    for (int i = 0; i < search->reached[t].size; i++){
+      enqueueVertex(search, search->reached[t].items[i]);
+    }
+    search->reached[t].size = 0;
+  }
+}
+
+/* Runs the phases of the search of 'arg', a DeltaWorker, taking vertices of
+ * each phase RELAX_CHUNK at a time, until the search is done. Worker 0 plans
+ * every phase before the others start it, and merges its results once they
+ * have all finished it.
+ */
+void* runDeltaWorker(void* arg){
+  DeltaWorker* worker = arg;
+  DeltaStepping* search = worker->search;
+  IntVector* reached = &search->reached[worker->index];
+  pthread_mutex_lock(&search->startLock);  // wait for the barrier to be set
+  pthread_mutex_unlock(&search->startLock);
+  while (true){
+    if (worker->index == 0){
+      planPhase(search);
+    }
+    pthread_barrier_wait(&search->barrier);
+    if (search->done){
+      break;
+    }
+    IntVector* work = search->heavy ? &search->settled : &search->frontier;
+    while (true){
+      int first = atomic_fetch_add(&search->nextChunk, RELAX_CHUNK);
+      if (first >= work->size){
+        break;
+      }
+      int last = first + RELAX_CHUNK < work->size ?
+                 first + RELAX_CHUNK : work->size;
+      for (int i = first; i < last; i++){
+        relaxEdges(search, work->items[i], reached);
+      }
+    }
+    pthread_barrier_wait(&search->barrier);
+    if (worker->index == 0){
+      mergeReached(search);
+    }
+  }
+  return NULL;
+}
+
+/*********************************************************************
+ * Required functions
+ ********************************************************************/
+/* Runs delta-stepping on the frozen graph 'graph' starting from vertex with
+ * ID 'startVertex', on 'numThreads' threads at once, and returns the
+ * resulting distance tree in the format of getDistanceTreeDijkstra:
+ * distTree[id] is (id -- predecessor, distance(id)), and (id -- -1, INT_MAX)
+ * if 'startVertex' cannot reach id. Buckets are 'delta' wide; if 'delta' is
+ * not positive, the maximum edge weight divided by the average out-degree
+ * is used. If 'numThreads' is not positive, uses one thread per online
+ * processor.
+ * Returns NULL if 'startVertex' is not valid in 'graph'.
+ * Note: the distances equal those of Dijkstra's algorithm, but among
+ * several shortest paths the predecessors may pick a different one.
+ */
+Edge* getDistanceTreeDeltaStepping(CSRGraph* graph, int startVertex,
+                                   int delta, int numThreads){
+  if (startVertex < 0 || startVertex >= graph->numVertices){
+    return NULL;
+  }
+  int numVertices = graph->numVertices;
+  if (delta <= 0){
+    // about one bucket per hop of average weight: wide enough for parallel
+    // work, narrow enough that few light edges need relaxing twice
+    delta = graph->numEdges > 0 ?
+            (int)((long)graph->maxWeight*numVertices/graph->numEdges) : 1;
+    if (delta < 1) delta = 1;
+  }
+  if (numThreads <= 0){
+    numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  if (numThreads < 1){
+    numThreads = 1;
+  }
+
+  DeltaStepping search;
+  search.graph = graph;
+  search.delta = delta;
+  search.labels = malloc(sizeof(_Atomic uint64_t)*numVertices);
+  search.queuedAt = malloc(sizeof(int)*numVertices);
+  search.relaxedAt = malloc(sizeof(int)*numVertices);
+  search.settledIn = malloc(sizeof(int)*numVertices);
+  for (int i = 0; i < numVertices; i++){
+    atomic_init(&search.labels[i], packLabel(UNREACHED, NOTHING));
+    search.queuedAt[i] = NOTHING;
+    search.relaxedAt[i] = NOTHING;
+    search.settledIn[i] = NOTHING;
+  }
+  // a tentative distance is at most delta-1 + maxWeight past the start of
+  // the current bucket, so this many buckets never wrap onto a live one
+  search.numBuckets = graph->maxWeight/delta + 2;
+  search.buckets = calloc(search.numBuckets, sizeof(IntVector));
+  search.numQueued = 0;
+  search.bucket = 0;
+  search.frontier = (IntVector){0, 0, NULL};
+  search.settled = (IntVector){0, 0, NULL};
+  search.heavy = false;
+  search.done = false;
+  atomic_init(&search.nextChunk, 0);
+
+  atomic_store(&search.labels[startVertex], packLabel(0, startVertex));
+  enqueueVertex(&search, startVertex);
+
+  DeltaWorker* workers = malloc(sizeof(DeltaWorker)*numThreads);
+  pthread_t* threads = malloc(sizeof(pthread_t)*numThreads);
+  search.reached = calloc(numThreads, sizeof(IntVector));
+  pthread_mutex_init(&search.startLock, NULL);
+  pthread_mutex_lock(&search.startLock);
+  // the calling thread is worker 0; if a thread cannot be started, the
+  // search runs on the ones that did start
+  int numStarted = 1;
+  for (int i = 0; i < numThreads; i++){
+    workers[i].search = &search;
+    workers[i].index = i;
+  }
+  while (numStarted < numThreads &&
+         pthread_create(&threads[numStarted], NULL, runDeltaWorker,
+                        &workers[numStarted]) == 0){
+    numStarted++;
+  }
+  search.numThreads = numStarted;
+  pthread_barrier_init(&search.barrier, NULL, numStarted);
+  pthread_mutex_unlock(&search.startLock);
+  runDeltaWorker(&workers[0]);
+  for (int i = 1; i < numStarted; i++){
+    pthread_join(threads[i], NULL);
+  }
+  pthread_barrier_destroy(&search.barrier);
+  pthread_mutex_destroy(&search.startLock);
+
+  // distTree[id] is (id -- predecessor, distance(id))
+  Edge* distTree = malloc(sizeof(Edge)*numVertices);
+  for (int v = 0; v < numVertices; v++){
+    uint64_t label = atomic_load(&search.labels[v]);
+    distTree[v].fromVertex = v;
+    distTree[v].toVertex = (int)(uint32_t)label;
+    distTree[v].weight = (int)(label >> 32);
+  }
+
+  for (int i = 0; i < search.numBuckets; i++){
+    free(search.buckets[i].items);
+  }
+  for (int t = 0; t < numThreads; t++){
+    free(search.reached[t].items);
+  }
+  free(search.buckets);
+  free(search.reached);
+  free(search.frontier.items);
+  free(search.settled.items);
+  free(search.labels);
+  free(search.queuedAt);
+  free(search.relaxedAt);
+  free(search.settledIn);
+  free(threads);
+  free(workers);
+  return distTree;
+}
@@ -0,0 +1,36 @@
+/*
+ * Header file for our delta-stepping shortest paths.
+ *
+ * Delta-stepping is Dijkstra's algorithm with coarse priorities: vertices
+ * are kept in buckets of width delta, and all vertices of the lowest bucket
+ * are settled together, relaxing their edges in parallel. Light edges
+ * (weight at most delta) may lead back into the same bucket, so they are
+ * relaxed repeatedly until the bucket stays empty; heavy edges cannot, so
+ * they are relaxed once, when the bucket is done.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __DeltaStep_header
+#define __DeltaStep_header
+
+/* Runs delta-stepping on the frozen graph 'graph' starting from vertex with
+ * ID 'startVertex', on 'numThreads' threads at once, and returns the
+ * resulting distance tree in the format of getDistanceTreeDijkstra:
+ * distTree[id] is (id -- predecessor, distance(id)), and (id -- -1, INT_MAX)
+ * if 'startVertex' cannot reach id. Buckets are 'delta' wide; if 'delta' is
+ * not positive, the maximum edge weight divided by the average out-degree
+ * is used. If 'numThreads' is not positive, uses one thread per online
+ * processor.
+ * Returns NULL if 'startVertex' is not valid in 'graph'.
+ * Note: the distances equal those of Dijkstra's algorithm, but among
+ * several shortest paths the predecessors may pick a different one.
+ */
+Edge* getDistanceTreeDeltaStepping(CSRGraph* graph, int startVertex,
+                                   int delta, int numThreads);
+
+#endif
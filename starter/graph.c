@@ -6,6 +6,35 @@
 
 #include "graph.h"
 
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ARENA_FIRST_SLAB (64 * 1024)        // bytes in the first arena slab
+#define ARENA_MAX_SLAB (64 * 1024 * 1024)   // slabs double up to this size
+#define IMAGE_MAGIC "CSRGRAPH"              // first bytes of a graph image
+#define IMAGE_VERSION 1                     // layout of the image below
+#define IMAGE_BYTE_ORDER 0x01020304u        // reads back differently if the
+                                            //   byte order differs
+
+typedef struct graph_image_header {  // start of a graph image file, followed
+                                     //   by offsets, targets and weights
+  char magic[8];           // IMAGE_MAGIC, without its terminating 0
+  uint32_t version;        // IMAGE_VERSION
+  uint32_t byteOrder;      // IMAGE_BYTE_ORDER
+  int32_t numVertices;     // total number of vertices
+  int32_t numEdges;        // total number of edges
+  int32_t maxWeight;       // the largest weight
+  uint32_t reserved;       // 0
+  uint64_t checksum;       // checksumCSR: the three counts above and the
+                           //   three arrays, in order
+  char padding[24];        // zeros, up to 64 bytes
+} GraphImageHeader;
+
 /*********************************************************************
  ** Helper function provided in the starter code
  *********************************************************************/
@@ -50,6 +79,26 @@ void printGraph(Graph* graph) {
   printf("\n");
 }
 
+void printCSRGraph(CSRGraph* csr) {
+  if (csr == NULL) {
+    printf("NULL");
+    return;
+  }
+  printf("Number of vertices: %d. Number of edges: %d.\n\n", csr->numVertices,
+         csr->numEdges);
+
+  for (int v = 0; v < csr->numVertices; v++) {
+    printf("%d: ", v);
+    for (int i = 0; i < csr->offsets[v+1] - csr->offsets[v]; i++) {
+      Edge edge = getCSREdge(csr, v, i);
+      printEdge(&edge);
+      printf(" --> ");
+    }
+    printf("NULL\n");
+  }
+  printf("\n");
+}
+
 /*********************************************************************
  ** Required functions
  *********************************************************************/
@@ -92,8 +141,118 @@ Vertex* newVertex(int id, void* value, EdgeList* adjList){
 Graph* newGraph(int numVertices){
   Graph *newGraph = malloc(sizeof(Graph));
   newGraph->numVertices = numVertices;
-  Vertex **verticies = malloc(sizeof(Vertex)*numVertices);
+  newGraph->vertices = calloc(numVertices, sizeof(Vertex*));  // all NULL
   newGraph->numEdges = 0;
+  newGraph->arena = NULL;
+  return newGraph;
+}
+
+/*********************************************************************
+ ** Arena allocation
+ *********************************************************************/
+/* Returns a newly created, empty ArenaSlab with room for 'capacity' bytes,
+ * that points to the older slab 'next'.
+ */
+ArenaSlab* newArenaSlab(size_t capacity, ArenaSlab* next){
+  ArenaSlab *slab = malloc(sizeof(ArenaSlab) + capacity);
+  if (slab == NULL) return NULL;
+  slab->next = next;
+  slab->used = 0;
+  slab->capacity = capacity;
+  return slab;
+}
+
+/* Returns 'size' bytes aligned to 'align' from the arena of 'graph', adding
+ * a new slab to the arena if the newest one is full. Returns NULL if out of
+ * memory.
+ * Precondition: 'graph' has an arena; 'align' is a power of two
+ */
+void* arenaAlloc(Graph* graph, size_t size, size_t align){
+  ArenaSlab *slab = graph->arena;
+  size_t start = (slab->used + align - 1) & ~(align - 1);
+  if (start + size > slab->capacity){
+    // slabs double in size, so a graph of E edges needs O(log E) of them
+    size_t capacity = slab->capacity * 2;
+    if (capacity > ARENA_MAX_SLAB) capacity = ARENA_MAX_SLAB;
+    if (capacity < size) capacity = size;
+    slab = newArenaSlab(capacity, slab);
+    if (slab == NULL) return NULL;
+    graph->arena = slab;
+    start = 0;  // slab data is malloc-aligned
+  }
+  slab->used = start + size;
+  return slab->data + start;
+}
+
+/* Returns a newly created Graph with space for 'numVertices' vertices, that
+ * owns the memory of its vertices and edges: the newGraph* functions below
+ * carve them out of large slabs instead of calling malloc for each node, and
+ * deleteGraph releases them a slab at a time.
+ * Returns NULL if there is no memory for the first slab.
+ * Precondition: numVertices >= 0
+ */
+Graph* newArenaGraph(int numVertices){
+  Graph *graph = newGraph(numVertices);
+  graph->arena = newArenaSlab(ARENA_FIRST_SLAB, NULL);
+  if (graph->arena == NULL){
+    free(graph->vertices);
+    free(graph);
+    return NULL;
+  }
+  return graph;
+}
+
+/* Moves the nodes allocated from the arena of 'other' into the arena of
+ * 'graph', so that deleteGraph(graph) frees them, and frees 'other'. Lets
+ * several threads allocate nodes for one graph, each from a graph of its
+ * own.
+ * Precondition: 'graph' and 'other' both have an arena
+ */
+void mergeArenas(Graph* graph, Graph* other){
+  // the slabs of 'other' go behind the newest slab of 'graph', which stays
+  // the one arenaAlloc allocates from
+  ArenaSlab *last = other->arena;
+  while (last->next != NULL){
+    last = last->next;
+  }
+  last->next = graph->arena->next;
+  graph->arena->next = other->arena;
+  other->arena = NULL;
+  free(other->vertices);
+  free(other);
+}
+
+/* Same as newEdge, newEdgeList and newVertex, but allocate the new node
+ * from the arena of 'graph' if it has one, and with malloc otherwise.
+ * Nodes allocated from an arena are freed only by deleteGraph(graph).
+ */
+Edge* newGraphEdge(Graph* graph, int fromVertex, int toVertex, int weight){
+  if (graph->arena == NULL) return newEdge(fromVertex, toVertex, weight);
+  Edge *edge = arenaAlloc(graph, sizeof(Edge), _Alignof(Edge));
+  if (edge == NULL) return NULL;
+  edge->fromVertex = fromVertex;
+  edge->toVertex = toVertex;
+  edge->weight = weight;
+  return edge;
+}
+
+EdgeList* newGraphEdgeList(Graph* graph, Edge* edge, EdgeList* next){
+  if (graph->arena == NULL) return newEdgeList(edge, next);
+  EdgeList *edgeList = arenaAlloc(graph, sizeof(EdgeList), _Alignof(EdgeList));
+  if (edgeList == NULL) return NULL;
+  edgeList->edge = edge;
+  edgeList->next = next;
+  return edgeList;
+}
+
+Vertex* newGraphVertex(Graph* graph, int id, void* value, EdgeList* adjList){
+  if (graph->arena == NULL) return newVertex(id, value, adjList);
+  Vertex *vertex = arenaAlloc(graph, sizeof(Vertex), _Alignof(Vertex));
+  if (vertex == NULL) return NULL;
+  vertex->id = id;
+  vertex->value = value;
+  vertex->adjList = adjList;
+  return vertex;
 }
 
 /* Frees memory allocated for EdgeList starting at 'head'.
@@ -111,16 +270,458 @@ void deleteEdgeList(EdgeList* head){
 /* Frees memory allocated for 'vertex' including its adjacency list.
  */
 void deleteVertex(Vertex* vertex){
+  if (vertex == NULL) return;
   deleteEdgeList(vertex->adjList);
   free(vertex);
 }
 
-/* Frees memory allocated for 'graph'.
+/* Frees memory allocated for 'graph', including all its vertices and edges.
  */
 void deleteGraph(Graph* graph){
-  for (int i = 0; i < graph->numVertices; i++) {
-        deleteVertex(graph->vertices[i]);   
+  if (graph == NULL) return;
+  if (graph->arena != NULL){
+    // every node lives in some slab: no need to walk the adjacency lists
+    ArenaSlab *slab = graph->arena;
+    while (slab != NULL){
+      ArenaSlab *next = slab->next;
+      free(slab);
+      slab = next;
     }
+  }
+  else{
+    for (int i = 0; i < graph->numVertices; i++) {
+          deleteVertex(graph->vertices[i]);   
+      }
+  }
   free(graph->vertices); 
   free(graph);         
-}
\ No newline at end of file
+}
+
+/*********************************************************************
+ ** Frozen graphs
+ *********************************************************************/
+/* Returns a newly created CSRGraph holding the same vertices and edges as
+ * 'graph', with the edges of every vertex in the order of its adjacency list.
+ * Later changes to 'graph' are not reflected in the result.
+ * Returns NULL if 'graph' is NULL.
+ */
+CSRGraph* freezeGraph(Graph* graph){
+  if (graph == NULL) return NULL;
+
+  int numVertices = graph->numVertices;
+  CSRGraph *csr = malloc(sizeof(CSRGraph));
+  csr->numVertices = numVertices;
+  csr->offsets = malloc(sizeof(int)*(numVertices+1));
+
+  // first pass: count out-degrees, turning them into running offsets
+  int numEdges = 0;
+  for (int v = 0; v < numVertices; v++){
+    csr->offsets[v] = numEdges;
+    if (graph->vertices[v] == NULL) continue;  // vertex with no line in input
+    for (EdgeList *e = graph->vertices[v]->adjList; e != NULL; e = e->next){
+      numEdges++;
+    }
+  }
+  csr->offsets[numVertices] = numEdges;
+  csr->numEdges = numEdges;
+  csr->image = NULL;
+  csr->imageBytes = 0;
+
+  // second pass: pack the edges of every vertex next to each other
+  csr->targets = malloc(sizeof(int)*numEdges);
+  csr->weights = malloc(sizeof(int)*numEdges);
+  csr->maxWeight = 0;
+  for (int v = 0; v < numVertices; v++){
+    if (graph->vertices[v] == NULL) continue;
+    int i = csr->offsets[v];
+    for (EdgeList *e = graph->vertices[v]->adjList; e != NULL; e = e->next){
+      csr->targets[i] = e->edge->toVertex;
+      csr->weights[i] = e->edge->weight;
+      if (e->edge->weight > csr->maxWeight) csr->maxWeight = e->edge->weight;
+      i++;
+    }
+  }
+  return csr;
+}
+
+/* Returns a newly created CSRGraph with 'numVertices' vertices, all offsets
+ * 0, and room for 'numEdges' targets and weights. The caller fills in the
+ * offsets, targets and weights, and then must call finishCSRGraph: until
+ * then 'maxWeight' is not set, and the algorithms pick their priority queue
+ * by it.
+ * Precondition: numVertices >= 0 and numEdges >= 0
+ */
+CSRGraph* newCSRGraph(int numVertices, int numEdges){
+  CSRGraph *csr = malloc(sizeof(CSRGraph));
+  csr->numVertices = numVertices;
+  csr->numEdges = numEdges;
+  csr->offsets = calloc(numVertices+1, sizeof(int));
+  csr->targets = malloc(sizeof(int)*numEdges);
+  csr->weights = malloc(sizeof(int)*numEdges);
+  csr->maxWeight = 0;
+  csr->image = NULL;
+  csr->imageBytes = 0;
+  return csr;
+}
+
+/* Sets the fields of 'csr' that follow from its arrays, i.e. 'maxWeight',
+ * once the caller of newCSRGraph has filled them in.
+ */
+void finishCSRGraph(CSRGraph* csr){
+  csr->maxWeight = 0;
+  for (int e = 0; e < csr->numEdges; e++){
+    if (csr->weights[e] > csr->maxWeight) csr->maxWeight = csr->weights[e];
+  }
+}
+
+/* Returns the 'i'-th edge of vertex with ID 'vertex' in 'csr' as an Edge
+ * (vertex -- target, weight). A CSRGraph keeps only the target and the
+ * weight of an edge, 8 bytes instead of the 40 or so an Edge in an
+ * adjacency list takes; the "from" vertex is known from where it is stored.
+ * Precondition: 'vertex' is valid in 'csr', and
+ *   0 <= i < csr->offsets[vertex+1] - csr->offsets[vertex]
+ */
+Edge getCSREdge(CSRGraph* csr, int vertex, int i){
+  int e = csr->offsets[vertex] + i;
+  return (Edge){vertex, csr->targets[e], csr->weights[e]};
+}
+
+/* Returns a newly created adjacency list holding the edges of vertex with ID
+ * 'vertex' in 'csr', in their order in 'csr', for code that expects one.
+ * The caller frees it with deleteEdgeList.
+ * Returns NULL if 'vertex' is not valid in 'csr' or has no edges.
+ */
+EdgeList* getCSRAdjList(CSRGraph* csr, int vertex){
+  if (csr == NULL || vertex < 0 || vertex >= csr->numVertices) return NULL;
+
+  EdgeList *head = NULL;
+  // built back to front, so that the list is in order
+  for (int e = csr->offsets[vertex+1] - 1; e >= csr->offsets[vertex]; e--){
+    head = newEdgeList(newEdge(vertex, csr->targets[e], csr->weights[e]),
+                       head);
+  }
+  return head;
+}
+
+/* Returns a newly created CSRGraph with the edges of 'csr' reversed: for
+ * every edge (u -- v, w) of 'csr' it has the edge (v -- u, w). The edges of
+ * a vertex keep the relative order they had in 'csr'.
+ * Returns NULL if 'csr' is NULL.
+ */
+CSRGraph* reverseCSRGraph(CSRGraph* csr){
+  if (csr == NULL) return NULL;
+
+  int numVertices = csr->numVertices;
+  CSRGraph *rev = malloc(sizeof(CSRGraph));
+  rev->numVertices = numVertices;
+  rev->numEdges = csr->numEdges;
+  rev->maxWeight = csr->maxWeight;
+  rev->image = NULL;
+  rev->imageBytes = 0;
+  rev->offsets = calloc(numVertices+1, sizeof(int));
+  rev->targets = malloc(sizeof(int)*csr->numEdges);
+  rev->weights = malloc(sizeof(int)*csr->numEdges);
+
+  // counting sort of the edges by "to" vertex: count in-degrees, shifted
+  // by one so that the prefix sums below become start offsets
+  for (int e = 0; e < csr->numEdges; e++){
+    rev->offsets[csr->targets[e]+1]++;
+  }
+  for (int v = 0; v < numVertices; v++){
+    rev->offsets[v+1] += rev->offsets[v];
+  }
+  int *next = malloc(sizeof(int)*(numVertices+1));  // next free slot
+  for (int v = 0; v <= numVertices; v++){
+    next[v] = rev->offsets[v];
+  }
+  for (int u = 0; u < numVertices; u++){
+    for (int e = csr->offsets[u]; e < csr->offsets[u+1]; e++){
+      int i = next[csr->targets[e]]++;
+      rev->targets[i] = u;
+      rev->weights[i] = csr->weights[e];
+    }
+  }
+  free(next);
+  return rev;
+}
+
+/* Returns 'hash' updated with the 'n' ints in 'values', a word at a time
+ * (FNV-1a on 32-bit words instead of bytes).
+ */
+uint64_t checksumInts(uint64_t hash, const int* values, size_t n){
+  for (size_t i = 0; i < n; i++){
+    hash ^= (uint32_t)values[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+/* Returns the checksum of 'csr' as stored in a graph image: of its numbers
+ * of vertices and edges, its largest weight, and its arrays.
+ */
+uint64_t checksumCSR(CSRGraph* csr){
+  uint64_t hash = 0xcbf29ce484222325ull;
+  int counts[3] = {csr->numVertices, csr->numEdges, csr->maxWeight};
+  hash = checksumInts(hash, counts, 3);
+  hash = checksumInts(hash, csr->offsets, (size_t)csr->numVertices + 1);
+  hash = checksumInts(hash, csr->targets, csr->numEdges);
+  hash = checksumInts(hash, csr->weights, csr->numEdges);
+  return hash;
+}
+
+/* Writes 'csr' to the file 'fileName' as a graph image: a header with a
+ * version, the byte order of this machine and a checksum, followed by the
+ * arrays 'offsets', 'targets' and 'weights' exactly as they are in memory.
+ * Returns true iff the whole image was written.
+ */
+bool saveGraphBinary(CSRGraph* csr, const char* fileName){
+  if (csr == NULL) return false;
+  FILE *f = fopen(fileName, "wb");
+  if (f == NULL) return false;
+
+  GraphImageHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, IMAGE_MAGIC, sizeof(header.magic));
+  header.version = IMAGE_VERSION;
+  header.byteOrder = IMAGE_BYTE_ORDER;
+  header.numVertices = csr->numVertices;
+  header.numEdges = csr->numEdges;
+  header.maxWeight = csr->maxWeight;
+  header.checksum = checksumCSR(csr);
+
+  size_t numEdges = csr->numEdges;
+  bool written =
+      fwrite(&header, sizeof(header), 1, f) == 1 &&
+      fwrite(csr->offsets, sizeof(int), csr->numVertices + 1, f) ==
+          (size_t)csr->numVertices + 1 &&
+      fwrite(csr->targets, sizeof(int), numEdges, f) == numEdges &&
+      fwrite(csr->weights, sizeof(int), numEdges, f) == numEdges;
+  if (fclose(f) != 0) written = false;
+  return written;
+}
+
+/* Returns true iff the offsets of 'csr' never decrease and stay within its
+ * edges, every target is a vertex of 'csr', and every weight is between 0
+ * and 'maxWeight', which is the largest (or 0 if there are no edges).
+ */
+bool isValidCSR(CSRGraph* csr){
+  if (csr->offsets[0] != 0 || csr->offsets[csr->numVertices] != csr->numEdges){
+    return false;
+  }
+  for (int v = 0; v < csr->numVertices; v++){
+    if (csr->offsets[v] > csr->offsets[v+1]) return false;
+  }
+  for (int e = 0; e < csr->numEdges; e++){
+    if (csr->targets[e] < 0 || csr->targets[e] >= csr->numVertices){
+      return false;
+    }
+  }
+  // the algorithms pick their priority queue by 'maxWeight'
+  bool reached = csr->maxWeight == 0;
+  for (int e = 0; e < csr->numEdges; e++){
+    if (csr->weights[e] < 0 || csr->weights[e] > csr->maxWeight) return false;
+    if (csr->weights[e] == csr->maxWeight) reached = true;
+  }
+  return reached;
+}
+
+/* Maps the graph image in the file 'fileName', written by saveGraphBinary,
+ * into memory and returns it as a CSRGraph whose arrays point straight into
+ * the mapping: nothing is parsed or copied, and pages are read from the file
+ * as the algorithms touch them. If 'verify' is true, first checks the
+ * checksum, which covers the header too, and that every offset, target and
+ * weight is in range, which reads the whole file.
+ * Returns NULL if the file cannot be mapped, is not a graph image of this
+ * version and byte order, or fails verification.
+ */
+CSRGraph* loadGraphBinary(const char* fileName, bool verify){
+  int fd = open(fileName, O_RDONLY);
+  if (fd < 0) return NULL;
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(GraphImageHeader)){
+    close(fd);
+    return NULL;
+  }
+  size_t imageBytes = info.st_size;
+  char *image = mmap(NULL, imageBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // the mapping keeps the file open
+  if (image == MAP_FAILED) return NULL;
+
+  GraphImageHeader *header = (GraphImageHeader*)image;
+  size_t numInts = (size_t)header->numVertices + 1 + 2*(size_t)header->numEdges;
+  if (memcmp(header->magic, IMAGE_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != IMAGE_VERSION ||
+      header->byteOrder != IMAGE_BYTE_ORDER ||
+      header->numVertices < 0 || header->numEdges < 0 ||
+      header->maxWeight < 0 ||
+      imageBytes != sizeof(GraphImageHeader) + sizeof(int)*numInts){
+    munmap(image, imageBytes);
+    return NULL;
+  }
+
+  CSRGraph *csr = malloc(sizeof(CSRGraph));
+  csr->numVertices = header->numVertices;
+  csr->numEdges = header->numEdges;
+  csr->maxWeight = header->maxWeight;
+  csr->offsets = (int*)(image + sizeof(GraphImageHeader));
+  csr->targets = csr->offsets + csr->numVertices + 1;
+  csr->weights = csr->targets + csr->numEdges;
+  csr->image = image;
+  csr->imageBytes = imageBytes;
+  if (verify && (checksumCSR(csr) != header->checksum || !isValidCSR(csr))){
+    deleteCSRGraph(csr);
+    return NULL;
+  }
+  return csr;
+}
+
+/* Frees memory allocated for 'csr', or unmaps it if it was loaded by
+ * loadGraphBinary.
+ */
+void deleteCSRGraph(CSRGraph* csr){
+  if (csr == NULL) return;
+  if (csr->image != NULL){
+    munmap(csr->image, csr->imageBytes);
+  }
+  else {
+    free(csr->offsets);
+    free(csr->targets);
+    free(csr->weights);
+  }
+  free(csr);
+}
+
+/*********************************************************************
+ ** Packed graphs
+ *********************************************************************/
+/* Writes 'value' to 'pos' as a varint: 7 bits per byte, lowest first, with
+ * the high bit set on every byte but the last. Returns the number of bytes
+ * written, at most 5.
+ */
+int writeVarint(unsigned char* pos, uint32_t value){
+  int n = 0;
+  while (value >= 0x80){
+    pos[n++] = (unsigned char)(value | 0x80);
+    value >>= 7;
+  }
+  pos[n++] = (unsigned char)value;
+  return n;
+}
+
+/* Compares Edges 'a' and 'b' by "to" vertex, then by weight, for qsort.
+ */
+int compareByTarget(const void* a, const void* b){
+  const Edge *x = a, *y = b;
+  if (x->toVertex != y->toVertex) return x->toVertex < y->toVertex ? -1 : 1;
+  return (x->weight > y->weight) - (x->weight < y->weight);
+}
+
+/* Returns a newly created PackedGraph holding the same vertices and edges as
+ * 'csr', with the edges of every vertex sorted by "to" vertex (and by weight
+ * among edges to the same vertex). An edge takes a varint, 7 bits per byte,
+ * for the difference between its "to" vertex and the previous one (the
+ * "from" vertex for the first edge), followed by a varint for its weight:
+ * 2 to 4 bytes for most edges of a graph whose neighbours have nearby IDs,
+ * instead of 8.
+ * Returns NULL if 'csr' is NULL, or if its edges take more than 4 GiB even
+ * when packed.
+ */
+PackedGraph* packGraph(CSRGraph* csr){
+  if (csr == NULL) return NULL;
+
+  int numVertices = csr->numVertices;
+  PackedGraph *packed = malloc(sizeof(PackedGraph));
+  packed->numVertices = numVertices;
+  packed->numEdges = csr->numEdges;
+  packed->maxWeight = csr->maxWeight;
+  packed->offsets = malloc(sizeof(uint32_t)*(numVertices+1));
+
+  // most edges take a few bytes; grow the buffer when one vertex might not
+  // fit, with up to 10 bytes per edge
+  size_t capacity = (size_t)csr->numEdges * 3 + 64;
+  unsigned char *bytes = malloc(capacity);
+  size_t used = 0;
+  Edge *sorted = NULL;
+  int sortedCapacity = 0;
+  for (int u = 0; u < numVertices && bytes != NULL; u++){
+    packed->offsets[u] = (uint32_t)used;
+    int degree = csr->offsets[u+1] - csr->offsets[u];
+    if (degree == 0){
+      continue;  // nothing to encode, and 'sorted' may still be NULL
+    }
+    if (used + (size_t)degree * 10 > capacity){
+      capacity = 2 * capacity + (size_t)degree * 10;
+      unsigned char *bigger = realloc(bytes, capacity);
+      if (bigger == NULL) free(bytes);
+      bytes = bigger;
+      if (bytes == NULL) break;
+    }
+    if (degree > sortedCapacity){
+      sortedCapacity = degree > 2*sortedCapacity ? degree : 2*sortedCapacity;
+      sorted = realloc(sorted, sizeof(Edge)*sortedCapacity);
+    }
+    for (int i = 0; i < degree; i++){
+      sorted[i] = getCSREdge(csr, u, i);
+    }
+    qsort(sorted, degree, sizeof(Edge), compareByTarget);
+
+    int previous = u;
+    for (int i = 0; i < degree; i++){
+      int difference = sorted[i].toVertex - previous;
+      // zigzag: 0, -1, 1, -2, ... as 0, 1, 2, 3, ..., see readPackedEdge
+      uint32_t zigzag =
+          ((uint32_t)difference << 1) ^ (uint32_t)(difference >> 31);
+      used += writeVarint(bytes + used, zigzag);
+      used += writeVarint(bytes + used, (uint32_t)sorted[i].weight);
+      previous = sorted[i].toVertex;
+    }
+    if (used > UINT32_MAX){
+      free(bytes);
+      bytes = NULL;
+    }
+  }
+  free(sorted);
+  if (bytes == NULL){
+    free(packed->offsets);
+    free(packed);
+    return NULL;
+  }
+  packed->offsets[numVertices] = (uint32_t)used;
+  // give back what the estimate left over; shrinking keeps the contents
+  packed->bytes = realloc(bytes, used > 0 ? used : 1);
+  return packed;
+}
+
+/* Returns a newly created CSRGraph holding the same vertices and edges as
+ * 'packed', in the order of 'packed', for the algorithms that have no
+ * packed variant.
+ * Returns NULL if 'packed' is NULL.
+ */
+CSRGraph* unpackGraph(PackedGraph* packed){
+  if (packed == NULL) return NULL;
+
+  CSRGraph *csr = newCSRGraph(packed->numVertices, packed->numEdges);
+  int e = 0;
+  for (int u = 0; u < packed->numVertices; u++){
+    csr->offsets[u] = e;
+    const unsigned char *pos = packed->bytes + packed->offsets[u];
+    const unsigned char *end = packed->bytes + packed->offsets[u+1];
+    int v = u;
+    while (pos < end){
+      pos = readPackedEdge(pos, &v, &csr->weights[e]);
+      csr->targets[e++] = v;
+    }
+  }
+  csr->offsets[packed->numVertices] = e;
+  finishCSRGraph(csr);
+  return csr;
+}
+
+/* Frees memory allocated for 'packed'.
+ */
+void deletePackedGraph(PackedGraph* packed){
+  if (packed == NULL) return;
+  free(packed->offsets);
+  free(packed->bytes);
+  free(packed);
+}
@@ -8,6 +8,7 @@
  */
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -31,12 +32,47 @@ typedef struct vertex {
   EdgeList* adjList;  // adjacency list of this vertex
 } Vertex;
 
+typedef struct arena_slab {  // one block of memory in an Arena
+  struct arena_slab* next;   // the previously filled slab, or NULL
+  size_t used;               // number of bytes handed out from 'data'
+  size_t capacity;           // size of 'data' in bytes
+  char data[];               // the memory handed out by the arena
+} ArenaSlab;
+
 typedef struct graph {
   int numVertices;    // total number of vertices
   int numEdges;       // total number of edges
   Vertex** vertices;  // numVertices Vertex pointers; vertices[v.id] = v
+  ArenaSlab* arena;   // slabs holding all Vertex, Edge and EdgeList nodes of
+                      //   this graph, newest first; NULL if the graph does
+                      //   not own its nodes (see newArenaGraph)
 } Graph;
 
+typedef struct csr_graph {  // immutable compressed sparse row view of a Graph,
+                            //   8 bytes per edge and 4 per vertex
+  int numVertices;  // total number of vertices
+  int numEdges;     // total number of edges
+  int* offsets;     // numVertices+1 offsets; the edges of vertex v are
+                    //   stored at indices offsets[v] .. offsets[v+1]-1
+  int* targets;     // numEdges IDs of "to" vertices, grouped by "from" vertex
+  int* weights;     // numEdges weights; weights[i] belongs to targets[i]
+  int maxWeight;    // the largest weight in 'weights', or 0 if there are none
+  void* image;      // the mapped graph image file the arrays above point
+                    //   into, or NULL if they were allocated
+  size_t imageBytes;  // size of the mapping of 'image'
+} CSRGraph;
+
+typedef struct packed_graph {  // a CSRGraph with compressed edges, for graphs
+                               //   too large to keep 8 bytes per edge
+  int numVertices;     // total number of vertices
+  int numEdges;        // total number of edges
+  uint32_t* offsets;   // numVertices+1 byte offsets; the edges of vertex v
+                       //   are encoded in bytes[offsets[v] .. offsets[v+1]-1]
+  unsigned char* bytes;  // the edges of every vertex, sorted by "to" vertex;
+                         //   see readPackedEdge
+  int maxWeight;       // the largest weight, or 0 if there are no edges
+} PackedGraph;
+
 /***** Displaying graph elements ********************************************/
 
 /* Prints Graph 'graph', including total number of vertices, total number of
@@ -53,6 +89,12 @@ void printEdgeList(EdgeList* head);
 /* Prints 'vertex', including the ID and the complete adjacency list. */
 void printVertex(Vertex* vertex);
 
+/* Prints CSRGraph 'csr' in the format of printGraph, with the edges of every
+ * vertex made into Edges on the fly. A vertex without edges is printed as
+ * "id: NULL", whether or not the graph it was frozen from had it.
+ */
+void printCSRGraph(CSRGraph* csr);
+
 /***** Memory management ***************************************************/
 
 /* Returns a newly created Edge from vertex with ID 'fromVertex' to vertex
@@ -76,16 +118,167 @@ Vertex* newVertex(int id, void* value, EdgeList* adjList);
  */
 Graph* newGraph(int numVertices);
 
+/* Returns a newly created Graph with space for 'numVertices' vertices, that
+ * owns the memory of its vertices and edges: the newGraph* functions below
+ * carve them out of large slabs instead of calling malloc for each node, and
+ * deleteGraph releases them a slab at a time.
+ * Returns NULL if there is no memory for the first slab.
+ * Precondition: numVertices >= 0
+ */
+Graph* newArenaGraph(int numVertices);
+
+/* Moves the nodes allocated from the arena of 'other' into the arena of
+ * 'graph', so that deleteGraph(graph) frees them, and frees 'other'. Lets
+ * several threads allocate nodes for one graph, each from a graph of its
+ * own.
+ * Precondition: 'graph' and 'other' both have an arena
+ */
+void mergeArenas(Graph* graph, Graph* other);
+
+/* Same as newEdge, newEdgeList and newVertex, but allocate the new node
+ * from the arena of 'graph' if it has one, and with malloc otherwise.
+ * Nodes allocated from an arena are freed only by deleteGraph(graph).
+ */
+Edge* newGraphEdge(Graph* graph, int fromVertex, int toVertex, int weight);
+EdgeList* newGraphEdgeList(Graph* graph, Edge* edge, EdgeList* next);
+Vertex* newGraphVertex(Graph* graph, int id, void* value, EdgeList* adjList);
+
 /* Frees memory allocated for EdgeList starting at 'head'.
+ * Precondition: the nodes of 'head' do not belong to an arena
  */
 void deleteEdgeList(EdgeList* head);
 
 /* Frees memory allocated for 'vertex' including its adjacency list.
+ * Precondition: 'vertex' does not belong to an arena
  */
 void deleteVertex(Vertex* vertex);
 
-/* Frees memory allocated for 'graph'.
+/* Frees memory allocated for 'graph', including all its vertices and edges.
  */
 void deleteGraph(Graph* graph);
 
+/***** Frozen graphs *******************************************************/
+
+/* Returns a newly created CSRGraph holding the same vertices and edges as
+ * 'graph', with the edges of every vertex in the order of its adjacency list.
+ * Later changes to 'graph' are not reflected in the result.
+ * Returns NULL if 'graph' is NULL.
+ */
+CSRGraph* freezeGraph(Graph* graph);
+
+/* Returns a newly created CSRGraph with 'numVertices' vertices, all offsets
+ * 0, and room for 'numEdges' targets and weights. The caller fills in the
+ * offsets, targets and weights, and then must call finishCSRGraph: until
+ * then 'maxWeight' is not set, and the algorithms pick their priority queue
+ * by it.
+ * Precondition: numVertices >= 0 and numEdges >= 0
+ */
+CSRGraph* newCSRGraph(int numVertices, int numEdges);
+
+/* Sets the fields of 'csr' that follow from its arrays, i.e. 'maxWeight',
+ * once the caller of newCSRGraph has filled them in.
+ */
+void finishCSRGraph(CSRGraph* csr);
+
+/* Returns the 'i'-th edge of vertex with ID 'vertex' in 'csr' as an Edge
+ * (vertex -- target, weight). A CSRGraph keeps only the target and the
+ * weight of an edge, 8 bytes instead of the 40 or so an Edge in an
+ * adjacency list takes; the "from" vertex is known from where it is stored.
+ * Precondition: 'vertex' is valid in 'csr', and
+ *   0 <= i < csr->offsets[vertex+1] - csr->offsets[vertex]
+ */
+Edge getCSREdge(CSRGraph* csr, int vertex, int i);
+
+/* Returns a newly created adjacency list holding the edges of vertex with ID
+ * 'vertex' in 'csr', in their order in 'csr', for code that expects one.
+ * The caller frees it with deleteEdgeList.
+ * Returns NULL if 'vertex' is not valid in 'csr' or has no edges.
+ */
+EdgeList* getCSRAdjList(CSRGraph* csr, int vertex);
+
+/* Returns a newly created CSRGraph with the edges of 'csr' reversed: for
+ * every edge (u -- v, w) of 'csr' it has the edge (v -- u, w). The edges of
+ * a vertex keep the relative order they had in 'csr'.
+ * Returns NULL if 'csr' is NULL.
+ */
+CSRGraph* reverseCSRGraph(CSRGraph* csr);
+
+/* Writes 'csr' to the file 'fileName' as a graph image: a header with a
+ * version, the byte order of this machine and a checksum, followed by the
+ * arrays 'offsets', 'targets' and 'weights' exactly as they are in memory.
+ * Returns true iff the whole image was written.
+ */
+bool saveGraphBinary(CSRGraph* csr, const char* fileName);
+
+/* Maps the graph image in the file 'fileName', written by saveGraphBinary,
+ * into memory and returns it as a CSRGraph whose arrays point straight into
+ * the mapping: nothing is parsed or copied, and pages are read from the file
+ * as the algorithms touch them. If 'verify' is true, first checks the
+ * checksum, which covers the header too, and that every offset, target and
+ * weight is in range, which reads the whole file.
+ * Returns NULL if the file cannot be mapped, is not a graph image of this
+ * version and byte order, or fails verification.
+ */
+CSRGraph* loadGraphBinary(const char* fileName, bool verify);
+
+/* Frees memory allocated for 'csr', or unmaps it if it was loaded by
+ * loadGraphBinary.
+ */
+void deleteCSRGraph(CSRGraph* csr);
+
+/***** Packed graphs *******************************************************/
+
+/* Returns a newly created PackedGraph holding the same vertices and edges as
+ * 'csr', with the edges of every vertex sorted by "to" vertex (and by weight
+ * among edges to the same vertex). An edge takes a varint, 7 bits per byte,
+ * for the difference between its "to" vertex and the previous one (the
+ * "from" vertex for the first edge), followed by a varint for its weight:
+ * 2 to 4 bytes for most edges of a graph whose neighbours have nearby IDs,
+ * instead of 8.
+ * Returns NULL if 'csr' is NULL, or if its edges take more than 4 GiB even
+ * when packed.
+ */
+PackedGraph* packGraph(CSRGraph* csr);
+
+/* Returns a newly created CSRGraph holding the same vertices and edges as
+ * 'packed', in the order of 'packed', for the algorithms that have no
+ * packed variant.
+ * Returns NULL if 'packed' is NULL.
+ */
+CSRGraph* unpackGraph(PackedGraph* packed);
+
+/* Frees memory allocated for 'packed'.
+ */
+void deletePackedGraph(PackedGraph* packed);
+
+/* Decodes the edge of a PackedGraph at 'pos': stores its "to" vertex in
+ * '*target', which must hold the "to" vertex of the previous edge (or the
+ * "from" vertex, for the first edge), and its weight in '*weight'. Returns
+ * the position of the next edge. Inline, as it runs once per edge in the
+ * relaxation loops of the algorithms:
+ *   const unsigned char* p = graph->bytes + graph->offsets[u];
+ *   const unsigned char* end = graph->bytes + graph->offsets[u+1];
+ *   int v = u, w;
+ *   while (p < end) {
+ *     p = readPackedEdge(p, &v, &w);
+ *     ...
+ *   }
+ */
+static inline const unsigned char* readPackedEdge(const unsigned char* pos,
+                                                  int* target, int* weight) {
+  // the difference is zigzag encoded: 0, -1, 1, -2, ... as 0, 1, 2, 3, ...
+  uint32_t value = *pos & 0x7f;
+  for (int shift = 7; *pos++ & 0x80; shift += 7) {
+    value |= (uint32_t)(*pos & 0x7f) << shift;
+  }
+  *target += (int)(value >> 1) ^ -(int)(value & 1);
+
+  value = *pos & 0x7f;
+  for (int shift = 7; *pos++ & 0x80; shift += 7) {
+    value |= (uint32_t)(*pos & 0x7f) << shift;
+  }
+  *weight = (int)value;
+  return pos;
+}
+
 #endif
@@ -4,25 +4,56 @@
  * Author (of starter code): A. Tafliovich.
  */
 
+#include <fcntl.h>
 #include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
+#include "bucketqueue.h"
 #include "graph.h"
+#include "graph_algos.h"
 #include "minheap.h"
 
 #define NOTHING -1
+#define UNREACHED INT_MAX  // distance of a vertex not reachable from the start
 #define DEBUG 0
+#define HEAP_ARITY 4  // children per heap node: shallow, one cache line each
+#define DIAL_MAX_WEIGHT 255  // Dijkstra's uses a bucket queue instead of a
+                             //   heap if no edge weighs more than this
+#define RESET_ALL_FRACTION 4  // resetRecords clears all vertices in order
+                              //   once more than 1/this were touched
+#define FLOYD_BLOCK 64  // Floyd-Warshall works on blocks of this many rows
+                        //   and columns: three blocks fit in L1 cache
+#define FLOYD_MAX_VERTICES 2048  // all-pairs distances use Floyd-Warshall
+#define FLOYD_MIN_DENSITY 8      //   only with at most this many vertices
+                                 //   and 1/this of all possible edges
 
 typedef struct records {
   int numVertices;    // total number of vertices in the graph
                       // vertex IDs are 0, 1, ..., numVertices-1
   MinHeap* heap;      // priority queue
+  BucketQueue* buckets;  // priority queue used instead of 'heap' for small
+                         //   integer weights, or NULL
   bool* finished;     // finished[id] is true iff vertex id is finished
                       //   i.e. no longer in the PQ
   int* predecessors;  // predecessors[id] is the predecessor of vertex id
   Edge* tree;         // keeps edges for the resulting tree
   int numTreeEdges;   // current number of edges in mst
+  int* touched;       // IDs of the vertices given a predecessor since the
+                      //   last reset, so that a reset can skip the others
+  int numTouched;     // number of IDs in 'touched'
+  bool allTouched;    // true iff vertices not in 'touched' may have changed
+                      //   too (markUnreached), and a reset must clear all
 } Records;
 
+MinHeap* initHeap(CSRGraph* graph, int startVertex);
+Records* newRecords(int numVertices);
+void setPredecessor(Records* records, int v, int predId);
+Records* newDijkstraRecordsFor(int numVertices, int maxWeight);
+Records* newHeapRecords(int numVertices);
+
 /*************************************************************************
  ** Suggested helper functions -- part of starter code
  *************************************************************************/
@@ -32,54 +63,103 @@ typedef struct records {
  * 'startVertex'.
  * Precondition: 'startVertex' is valid in 'graph'
  */
-Records* initRecords(Graph* graph, int startVertex){
-  Records *initRecords = malloc(sizeof(Records)); 
-  initRecords->numVertices = graph->numVertices;
-  
- 
+Records* initRecords(CSRGraph* graph, int startVertex){
+  Records *initRecords = newRecords(graph->numVertices);
   initRecords->heap = initHeap(graph, startVertex);
+  return initRecords;
+}
 
-  bool *trackFinished = malloc(sizeof(bool)*graph->numVertices);
-  for (int i = 0; i++; i < graph->numVertices){
+/* Creates and returns records for a graph with 'numVertices' vertices, with
+ * no priority queue: nothing is finished, no vertex has a predecessor and
+ * the tree is empty.
+ */
+Records* newRecords(int numVertices){
+  Records *records = malloc(sizeof(Records)); 
+  records->numVertices = numVertices;
+  records->heap = NULL;
+  records->buckets = NULL;
+
+  bool *trackFinished = malloc(sizeof(bool)*numVertices);
+  for (int i = 0; i < numVertices; i++){
     trackFinished[i] = false;
   }
-  initRecords->finished = trackFinished;
+  records->finished = trackFinished;
 
-  int *pred = malloc(sizeof(int)*graph->numVertices);
-  for (int i = 0; i++; i < graph->numVertices){
+  int *pred = malloc(sizeof(int)*numVertices);
+  for (int i = 0; i < numVertices; i++){
     pred[i] = NOTHING;
   }
-  initRecords->predecessors = pred;
+  records->predecessors = pred;
 
-  Edge *tree = malloc(sizeof(Edge)*(graph->numVertices-1));
-  for (int i = 0; i++; i < (graph->numVertices-1)){
+  // Dijkstra's keeps one edge per vertex (indexed by vertex ID), Prim's one
+  // edge per vertex but the start vertex
+  Edge *tree = malloc(sizeof(Edge)*numVertices);
+  for (int i = 0; i < numVertices; i++){
     tree[i].fromVertex = NOTHING;
     tree[i].toVertex = NOTHING;
     tree[i].weight = NOTHING;
   }
-  initRecords->tree = tree;
+  records->tree = tree;
 
-  initRecords->numTreeEdges = 0;
+  records->numTreeEdges = 0;
+  records->touched = malloc(sizeof(int)*numVertices);
+  records->numTouched = 0;
+  records->allTouched = false;
 
-  return initRecords;
+  return records;
 }
 
 /* Creates, populates, and returns a MinHeap to be used by Prim's and
  * Dijkstra's algorithms on Graph 'graph' starting from vertex with ID
  * 'startVertex'.
+ * Note: only the start vertex is inserted; every other vertex is inserted
+ * by relaxVertex when it is first reached, so the heap never holds more
+ * than the current frontier.
  * Precondition: 'startVertex' is valid in 'graph'
  */
-MinHeap* initHeap(Graph* graph, int startVertex){
-  MinHeap *heap = newHeap(graph->numVertices);
-  for (int i = 0; i++; i < graph->numVertices){
-    if (graph->vertices[i]->id == startVertex){
-      insert(heap,0,graph->vertices[i]->id);
+MinHeap* initHeap(CSRGraph* graph, int startVertex){
+  MinHeap *heap = newHeapWithArity(graph->numVertices, HEAP_ARITY);
+  insert(heap,0,startVertex);
+  return heap;
+}
+
+/* Sets the predecessor of vertex 'v' in 'records' to 'predId', noting 'v'
+ * as touched the first time.
+ */
+void setPredecessor(Records* records, int v, int predId){
+  if (records->predecessors[v] == NOTHING){
+    records->touched[records->numTouched++] = v;
+  }
+  records->predecessors[v] = predId;
+}
+
+/* Offers vertex 'v' the priority 'priority' via its neighbour 'predId':
+ * inserts 'v' into the priority queue of 'records', the bucket queue if it
+ * has one and the heap otherwise, if it was not reached before, or lowers
+ * its priority if 'priority' is smaller than the current one. Updates the
+ * predecessor of 'v' in either case. Has no effect if 'v' is finished.
+ */
+void relaxVertex(Records* records, int v, int priority, int predId){
+  if (records->finished[v]){
+    return;
+  }
+  BucketQueue* queue = records->buckets;
+  if (queue != NULL){
+    if (!bucketContains(queue, v)){
+      bucketInsert(queue, priority, v);
+      setPredecessor(records, v, predId);
     }
-    else{
-      insert(heap,99999,graph->vertices[i]->id);
+    else if (bucketDecreasePriority(queue, v, priority)){
+      setPredecessor(records, v, predId);
     }
   }
-  return heap;
+  else if (!isInHeap(records->heap, v)){
+    insert(records->heap, priority, v);
+    setPredecessor(records, v, predId);
+  }
+  else if (decreasePriority(records->heap, v, priority)){
+    setPredecessor(records, v, predId);
+  }
 }
 
 /* Returns true iff 'heap' is NULL or is empty. */
@@ -102,24 +182,6 @@ void addTreeEdge(Records* records, int ind, int fromVertex, int toVertex, int we
 
                  
 
-/* Creates and returns a path from 'vertex' to 'startVertex' from edges
- * in the distance tree 'distTree'.
- */
-EdgeList* makePath(Edge* distTree, int vertex, int startVertex){
-  
-  Edge* holder = distTree;
-  while (holder->toVertex != vertex){
-    holder = holder + 1;
-  }
-  if(holder->fromVertex == startVertex){
-    return newEdgeList(holder,NULL);
-  }
-  else{
-    EdgeList *resultPath = newEdgeList(holder, makePath(distTree,holder->fromVertex,startVertex));
-    return resultPath;
-  }
-}
-
 bool isValidVertex(Graph* graph, int vertexIndex){
   if (vertexIndex >= 0 && vertexIndex < graph->numVertices){
     return true;
@@ -137,23 +199,542 @@ bool isValidVertex(Graph* graph, int vertexIndex){
 }*/
 
 void deleteRecords(Records *records){
-  deleteHeap(records->heap);
+  if (records->heap != NULL) deleteHeap(records->heap);
+  if (records->buckets != NULL) deleteBucketQueue(records->buckets);
   free(records->finished);
   free(records->predecessors);
   free(records->tree);
+  free(records->touched);
+  free(records);
+}
+
+/* Fills the distance tree entry of every vertex that Dijkstra's algorithm
+ * did not reach with (id -- NOTHING, UNREACHED).
+ */
+void markUnreached(Records* records){
+  records->allTouched = true;
+  for (int i = 0; i < records->numVertices; i++){
+    if (!records->finished[i]){
+      addTreeEdge(records, i, i, NOTHING, UNREACHED);
+    }
+  }
+}
+
+/* Hands the tree kept in 'records' over to the caller and frees the rest of
+ * 'records'. */
+Edge* releaseTree(Records* records){
+  Edge* tree = records->tree;
+  records->tree = NULL;
+  deleteRecords(records);
+  return tree;
 }
 
-void copyPath(EdgeList* newpath, EdgeList* oldpath){
-  newpath->edge->fromVertex = oldpath->edge->fromVertex;
-  newpath->edge->toVertex = oldpath->edge->toVertex;
-  newpath->edge->weight = oldpath->edge->weight;
-  
-  if(oldpath->next != NULL){
-    copyPath(newpath->next, oldpath->next);
+/* Creates and returns records for Dijkstra's algorithm on 'graph', with the
+ * priority queue it needs: a bucket queue if all edge weights are small, and
+ * a heap otherwise. The records can be used for any number of searches on
+ * 'graph'; see dijkstraSearchWith.
+ */
+Records* newDijkstraRecords(CSRGraph* graph){
+  return newDijkstraRecordsFor(graph->numVertices, graph->maxWeight);
+}
+
+/* Same as newDijkstraRecords, but for any graph with 'numVertices' vertices
+ * and largest edge weight 'maxWeight'.
+ */
+Records* newDijkstraRecordsFor(int numVertices, int maxWeight){
+  Records* records = newRecords(numVertices);
+  if (maxWeight <= DIAL_MAX_WEIGHT){
+    records->buckets = newBucketQueue(numVertices, maxWeight);
   }
-  else{
-    newpath->next = NULL;
+  else {
+    records->heap = newHeapWithArity(numVertices, HEAP_ARITY);
   }
+  return records;
+}
+
+/* Creates and returns records for a graph with 'numVertices' vertices with
+ * an empty heap, as A* and bidirectional searches need.
+ */
+Records* newHeapRecords(int numVertices){
+  Records* records = newRecords(numVertices);
+  records->heap = newHeapWithArity(numVertices, HEAP_ARITY);
+  return records;
+}
+
+/* Makes 'records' ready for a new search: empties its priority queue, marks
+ * every vertex as not finished and without a predecessor, and empties the
+ * tree, allocating a new one if the last tree was handed over. Clears only
+ * the vertices the last search touched, unless its whole tree was filled
+ * in or handed over, so a reset after a short search is cheap.
+ * Precondition: the tree of 'records' is indexed by vertex ID, as
+ *               Dijkstra's algorithm keeps it, not by edge as Prim's does
+ */
+void resetRecords(Records* records){
+  int numVertices = records->numVertices;
+  if (records->heap != NULL){
+    clearHeap(records->heap);
+  }
+  if (records->buckets != NULL){
+    clearBucketQueue(records->buckets);
+  }
+  if (records->tree == NULL){
+    records->tree = malloc(sizeof(Edge)*numVertices);
+    records->allTouched = true;
+  }
+  if (records->numTouched > numVertices / RESET_ALL_FRACTION){
+    records->allTouched = true;  // one pass in order beats scattered writes
+  }
+  if (records->allTouched){
+    for (int i = 0; i < numVertices; i++){
+      records->finished[i] = false;
+      records->predecessors[i] = NOTHING;
+      records->tree[i] = (Edge){NOTHING, NOTHING, NOTHING};
+    }
+  }
+  else {
+    for (int i = 0; i < records->numTouched; i++){
+      int v = records->touched[i];
+      records->finished[v] = false;
+      records->predecessors[v] = NOTHING;
+      records->tree[v] = (Edge){NOTHING, NOTHING, NOTHING};
+    }
+  }
+  records->numTouched = 0;
+  records->allTouched = false;
+  records->numTreeEdges = 0;
+}
+
+/* Starts a search of Dijkstra's algorithm from vertex 'startVertex' in
+ * 'records': inserts it into the priority queue with priority 0, as its own
+ * predecessor.
+ * Precondition: 'records' is reset and was created by newDijkstraRecordsFor
+ */
+void startDijkstra(Records* records, int startVertex){
+  if (records->buckets != NULL){
+    bucketInsert(records->buckets, 0, startVertex);
+  }
+  else {
+    insert(records->heap, 0, startVertex);
+  }
+  setPredecessor(records, startVertex, startVertex);
+}
+
+/* Returns true iff the priority queue of 'records' is empty. */
+bool isQueueEmpty(Records* records){
+  if (records->buckets != NULL){
+    return records->buckets->size == 0;
+  }
+  return isEmpty(records->heap);
+}
+
+/* Removes the vertex with minimum priority from the priority queue of
+ * 'records', marks it finished, adds (id -- predecessor, distance(id)) to
+ * the distance tree, and returns it.
+ * Precondition: the priority queue of 'records' is non-empty
+ */
+HeapNode settleNext(Records* records){
+  HeapNode u = records->buckets != NULL ? bucketExtractMin(records->buckets)
+                                        : extractMin(records->heap);
+  records->finished[u.id] = true;
+  addTreeEdge(records, u.id, u.id, records->predecessors[u.id], u.priority);
+  return u;
+}
+
+/* Runs Dijkstra's algorithm on 'graph' from vertex 'startVertex' until
+ * vertex 'target' is finished, or until every vertex reachable from
+ * 'startVertex' is finished if 'target' is NOTHING, keeping its state in
+ * 'records': for every finished vertex 'id', tree[id] is
+ * (id -- predecessor, distance(id)).
+ * Precondition: 'startVertex' is valid in 'graph'
+ *               'records' is reset and was created by newDijkstraRecords
+ *               for 'graph'
+ */
+void dijkstraSearchWith(CSRGraph* graph, Records* records, int startVertex,
+                        int target){
+  startDijkstra(records, startVertex);
+  while (!isQueueEmpty(records)){
+    HeapNode u = settleNext(records);
+    if (u.id == target){
+      break;
+    }
+    for (int e = graph->offsets[u.id]; e < graph->offsets[u.id+1]; e++){
+      int v = graph->targets[e];
+      int d = u.priority + graph->weights[e];
+      relaxVertex(records, v, d, u.id);
+    }
+  }
+}
+
+/* Runs Dijkstra's algorithm on 'graph' from vertex 'startVertex' until
+ * vertex 'target' is finished, or until every vertex reachable from
+ * 'startVertex' is finished if 'target' is NOTHING. Returns the records of
+ * the search: for every finished vertex 'id', tree[id] is
+ * (id -- predecessor, distance(id)).
+ * Note: uses a bucket queue if all edge weights are small, and a heap
+ * otherwise.
+ * Precondition: 'startVertex' is valid in 'graph'
+ */
+Records* dijkstraSearch(CSRGraph* graph, int startVertex, int target){
+  // records holds a lot of dynamic memory which need to free later
+  Records* records = newDijkstraRecords(graph);
+  dijkstraSearchWith(graph, records, startVertex, target);
+  return records;
+}
+
+/* Computes the distance trees of a batch of sources on 'graph', one worker
+ * thread per BatchWorker; the workers share everything but 'records'.
+ */
+typedef struct batch_job {
+  CSRGraph* graph;     // the graph, read-only
+  int* sources;        // the start vertices, or NULL for all vertices in
+                       //   order of ID
+  int numSources;      // number of start vertices
+  Edge** trees;        // trees[i] is the distance tree from sources[i]
+  int* distances;      // if not NULL, trees are not kept: row i of this
+                       //   numSources x numVertices matrix gets the
+                       //   distances from sources[i] instead
+  int nextSource;      // index of the next source no worker has taken
+  pthread_mutex_t lock;  // guards nextSource
+} BatchJob;
+
+typedef struct batch_worker {
+  BatchJob* job;       // the batch this worker helps with
+  Records* records;    // this worker's workspace, reused for every source
+} BatchWorker;
+
+/* Takes sources of the batch of 'arg', a BatchWorker, one at a time until
+ * none are left, and stores the distance tree, or the distances, of each in
+ * the batch.
+ */
+void* runBatchWorker(void* arg){
+  BatchWorker* worker = arg;
+  BatchJob* job = worker->job;
+  Records* records = worker->records;
+  int numVertices = job->graph->numVertices;
+  while (true){
+    pthread_mutex_lock(&job->lock);
+    int i = job->nextSource++;
+    pthread_mutex_unlock(&job->lock);
+    if (i >= job->numSources){
+      break;
+    }
+    int startVertex = job->sources == NULL ? i : job->sources[i];
+    if (startVertex < 0 || startVertex >= numVertices){
+      job->trees[i] = NULL;
+      continue;
+    }
+    resetRecords(records);
+    dijkstraSearchWith(job->graph, records, startVertex, NOTHING);
+    if (job->distances != NULL){
+      int* row = job->distances + (size_t)i*numVertices;
+      for (int v = 0; v < numVertices; v++){
+        row[v] = records->finished[v] ? records->tree[v].weight : UNREACHED;
+      }
+      continue;
+    }
+    markUnreached(records);
+    job->trees[i] = records->tree;
+    records->tree = NULL;  // handed over; reset makes a new one
+  }
+  return NULL;
+}
+
+/* Runs the batch 'job' on 'numThreads' threads, the calling one included,
+ * each with its own records, and returns when all sources are done.
+ * If 'numThreads' is not positive, uses one thread per online processor.
+ */
+void runBatch(BatchJob* job, int numThreads){
+  if (numThreads <= 0){
+    numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  if (numThreads > job->numSources){
+    numThreads = job->numSources;
+  }
+  if (numThreads < 1){
+    numThreads = 1;
+  }
+  job->nextSource = 0;
+  pthread_mutex_init(&job->lock, NULL);
+
+  BatchWorker* workers = malloc(sizeof(BatchWorker)*numThreads);
+  pthread_t* threads = malloc(sizeof(pthread_t)*numThreads);
+  for (int i = 0; i < numThreads; i++){
+    workers[i].job = job;
+    workers[i].records = newDijkstraRecords(job->graph);
+  }
+  // the calling thread is worker 0; if a thread cannot be started, the
+  // workers that did start take over its share
+  int numStarted = 1;
+  while (numStarted < numThreads &&
+         pthread_create(&threads[numStarted], NULL, runBatchWorker,
+                        &workers[numStarted]) == 0){
+    numStarted++;
+  }
+  runBatchWorker(&workers[0]);
+  for (int i = 1; i < numStarted; i++){
+    pthread_join(threads[i], NULL);
+  }
+
+  for (int i = 0; i < numThreads; i++){
+    deleteRecords(workers[i].records);
+  }
+  free(threads);
+  free(workers);
+  pthread_mutex_destroy(&job->lock);
+}
+
+/* Creates and returns an all-pairs distance matrix for 'numVertices'
+ * vertices, with all distances UNREACHED. If 'fileName' is not NULL, the
+ * matrix lives in the file 'fileName', which is created or truncated and
+ * mapped into memory. Returns NULL if the file cannot be created or mapped.
+ */
+DistanceMatrix* newDistanceMatrix(int numVertices, const char* fileName){
+  size_t numBytes = sizeof(int)*(size_t)numVertices*numVertices;
+  int* distances;
+  size_t mappedBytes = 0;
+  if (fileName != NULL && numBytes > 0){
+    int fd = open(fileName, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0){
+      return NULL;
+    }
+    if (ftruncate(fd, (off_t)numBytes) != 0){
+      close(fd);
+      return NULL;
+    }
+    distances = mmap(NULL, numBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                     0);
+    close(fd);  // the mapping keeps the file open
+    if (distances == MAP_FAILED){
+      return NULL;
+    }
+    mappedBytes = numBytes;
+  }
+  else {
+    distances = malloc(numBytes > 0 ? numBytes : 1);
+  }
+  for (size_t i = 0; i < (size_t)numVertices*numVertices; i++){
+    distances[i] = UNREACHED;
+  }
+
+  DistanceMatrix* matrix = malloc(sizeof(DistanceMatrix));
+  matrix->numVertices = numVertices;
+  matrix->distances = distances;
+  matrix->mappedBytes = mappedBytes;
+  return matrix;
+}
+
+/* Relaxes every pair (i, j) with i in rows 'iBlock', j in columns 'jBlock'
+ * of the 'numVertices' x 'numVertices' matrix 'dist' through every vertex k
+ * in block 'kBlock', where block b covers FLOYD_BLOCK IDs from
+ * b*FLOYD_BLOCK on.
+ */
+void floydWarshallBlock(int* dist, int numVertices, int iBlock, int jBlock,
+                        int kBlock){
+  int iEnd = (iBlock+1)*FLOYD_BLOCK < numVertices ?
+             (iBlock+1)*FLOYD_BLOCK : numVertices;
+  int jEnd = (jBlock+1)*FLOYD_BLOCK < numVertices ?
+             (jBlock+1)*FLOYD_BLOCK : numVertices;
+  int kEnd = (kBlock+1)*FLOYD_BLOCK < numVertices ?
+             (kBlock+1)*FLOYD_BLOCK : numVertices;
+  for (int k = kBlock*FLOYD_BLOCK; k < kEnd; k++){
+    int* rowK = dist + (size_t)k*numVertices;
+    for (int i = iBlock*FLOYD_BLOCK; i < iEnd; i++){
+      int* rowI = dist + (size_t)i*numVertices;
+      int distIK = rowI[k];
+      if (distIK == UNREACHED){
+        continue;
+      }
+      for (int j = jBlock*FLOYD_BLOCK; j < jEnd; j++){
+        if (rowK[j] != UNREACHED && distIK + rowK[j] < rowI[j]){
+          rowI[j] = distIK + rowK[j];
+        }
+      }
+    }
+  }
+}
+
+/* Fills the all-pairs distance matrix 'matrix' of 'graph' with the
+ * Floyd-Warshall algorithm, tiled into FLOYD_BLOCK x FLOYD_BLOCK blocks so
+ * that the rows each step reads stay in cache.
+ * Precondition: 'matrix' was created by newDistanceMatrix for 'graph'
+ */
+void floydWarshall(CSRGraph* graph, DistanceMatrix* matrix){
+  int numVertices = graph->numVertices;
+  int* dist = matrix->distances;
+  for (int u = 0; u < numVertices; u++){
+    int* rowU = dist + (size_t)u*numVertices;
+    rowU[u] = 0;
+    for (int e = graph->offsets[u]; e < graph->offsets[u+1]; e++){
+      if (graph->weights[e] < rowU[graph->targets[e]]){
+        rowU[graph->targets[e]] = graph->weights[e];
+      }
+    }
+  }
+
+  // for each block of intermediate vertices k: first the block on the
+  // diagonal, which depends only on itself, then the rest of its block row
+  // and block column, which depend on the diagonal block, then all others
+  int numBlocks = (numVertices + FLOYD_BLOCK - 1)/FLOYD_BLOCK;
+  for (int k = 0; k < numBlocks; k++){
+    floydWarshallBlock(dist, numVertices, k, k, k);
+    for (int b = 0; b < numBlocks; b++){
+      if (b != k){
+        floydWarshallBlock(dist, numVertices, k, b, k);
+        floydWarshallBlock(dist, numVertices, b, k, k);
+      }
+    }
+    for (int i = 0; i < numBlocks; i++){
+      for (int j = 0; j < numBlocks; j++){
+        if (i != k && j != k){
+          floydWarshallBlock(dist, numVertices, i, j, k);
+        }
+      }
+    }
+  }
+}
+
+/* Returns the current distance estimate of vertex 'v' in the search kept in
+ * 'records': its distance if it is finished, its priority if it is in the
+ * heap, and UNREACHED if the search has not reached it yet.
+ */
+int labelOf(Records* records, int v){
+  if (records->finished[v]){
+    return records->tree[v].weight;
+  }
+  if (records->heap != NULL && isInHeap(records->heap, v)){
+    return getPriority(records->heap, v);
+  }
+  return UNREACHED;
+}
+
+/* Creates and returns the path from the start vertex of the search kept in
+ * 'records' to the vertex 'target', along the predecessors:
+ *   [(start -- id_1, w_0), (id_1 -- id_2, w_1), ..., (id_n -- target, w_n)]
+ * Returns NULL if 'target' is the start vertex.
+ * Precondition: 'target' is reached in 'records'
+ */
+EdgeList* makePathTo(Records* records, int target){
+  EdgeList* path = NULL;
+  int v = target;
+  int predId = records->predecessors[v];
+  while (predId != v){  // the start vertex is its own predecessor
+    int weight = labelOf(records, v) - labelOf(records, predId);
+    path = newEdgeList(newEdge(predId, v, weight), path);
+    v = predId;
+    predId = records->predecessors[v];
+  }
+  return path;
+}
+
+/* Runs an A* search on 'graph' from vertex 'source' until vertex 'target'
+ * is finished, ordering the heap by distance from 'source' plus
+ * 'heuristic', and keeping its state in 'records': for every finished
+ * vertex 'id', tree[id] is (id -- predecessor, distance(id)).
+ * Precondition: 'source' and 'target' are valid in 'graph'
+ *               'heuristic' is consistent
+ *               'records' is reset and has a heap for 'graph'
+ */
+void aStarSearchWith(CSRGraph* graph, Records* records, int source,
+                     int target, DistanceHeuristic heuristic, void* context){
+  insert(records->heap, heuristic(source, target, context), source);
+  setPredecessor(records, source, source);
+  while (!isEmpty(records->heap)){
+    HeapNode u = extractMin(records->heap);
+    records->finished[u.id] = true;
+    // with a consistent heuristic, u's distance is final once extracted
+    int distU = u.priority - heuristic(u.id, target, context);
+    addTreeEdge(records, u.id, u.id, records->predecessors[u.id], distU);
+    if (u.id == target){
+      break;
+    }
+    for (int e = graph->offsets[u.id]; e < graph->offsets[u.id+1]; e++){
+      int v = graph->targets[e];
+      if (records->finished[v]){
+        continue;
+      }
+      int estimate = distU + graph->weights[e] + heuristic(v, target, context);
+      relaxVertex(records, v, estimate, u.id);
+    }
+  }
+}
+
+/* Settles the next vertex of one side of a bidirectional search: extracts
+ * the vertex with minimum priority from the heap of 'records' and relaxes
+ * its edges in 'graph'. Every vertex reached by both this search and the
+ * opposite search 'other' is a meeting point; if the path through it is
+ * shorter than '*best', updates '*best' and '*meet'.
+ * Precondition: the heap of 'records' is non-empty
+ */
+void bidirectionalStep(CSRGraph* graph, Records* records, Records* other,
+                       int* best, int* meet){
+  HeapNode u = extractMin(records->heap);
+  records->finished[u.id] = true;
+  addTreeEdge(records, u.id, u.id, records->predecessors[u.id], u.priority);
+  for (int e = graph->offsets[u.id]; e < graph->offsets[u.id+1]; e++){
+    int v = graph->targets[e];
+    relaxVertex(records, v, u.priority + graph->weights[e], u.id);
+    int otherLabel = labelOf(other, v);
+    if (otherLabel != UNREACHED && labelOf(records, v) + otherLabel < *best){
+      *best = labelOf(records, v) + otherLabel;
+      *meet = v;
+    }
+  }
+}
+
+/* Searches 'graph' forward from vertex 'source' and 'reverse', its
+ * reversed edges, backward from vertex 'target', keeping their state in
+ * 'forward' and 'backward', until the two searches meet, and returns a
+ * shortest path from 'source' to 'target', or NULL if there is none.
+ * Precondition: 'source' and 'target' are valid in 'graph' and differ
+ *               'reverse' is reverseCSRGraph('graph')
+ *               'forward' and 'backward' are reset and have heaps
+ */
+EdgeList* bidirectionalSearchWith(CSRGraph* graph, CSRGraph* reverse,
+                                  Records* forward, Records* backward,
+                                  int source, int target){
+  insert(forward->heap, 0, source);
+  setPredecessor(forward, source, source);
+  insert(backward->heap, 0, target);
+  setPredecessor(backward, target, target);
+
+  int best = UNREACHED;  // length of the shortest path found so far
+  int meet = NOTHING;    // the vertex that path goes through
+  // each round settles a vertex on the side with the closer frontier; once
+  // the two frontiers together are at least 'best' away, no path through
+  // an unsettled vertex can be shorter
+  while (!isEmpty(forward->heap) && !isEmpty(backward->heap) &&
+         (best == UNREACHED ||
+          getMin(forward->heap).priority + getMin(backward->heap).priority <
+              best)){
+    if (getMin(forward->heap).priority <= getMin(backward->heap).priority){
+      bidirectionalStep(graph, forward, backward, &best, &meet);
+    }
+    else{
+      bidirectionalStep(reverse, backward, forward, &best, &meet);
+    }
+  }
+
+  EdgeList* path = NULL;
+  if (meet != NOTHING){
+    // source -> meet along the forward predecessors, then meet -> target
+    // along the backward ones
+    path = makePathTo(forward, meet);
+    EdgeList* tail = NULL;
+    EdgeList** end = &tail;
+    for (int v = meet; v != target; v = backward->predecessors[v]){
+      int next = backward->predecessors[v];
+      int weight = labelOf(backward, v) - labelOf(backward, next);
+      *end = newEdgeList(newEdge(v, next, weight), NULL);
+      end = &(*end)->next;
+    }
+    end = &path;
+    while (*end != NULL){
+      end = &(*end)->next;
+    }
+    *end = tail;
+  }
+
+  return path;
 }
 
 /*************************************************************************
@@ -163,12 +744,27 @@ void copyPath(EdgeList* newpath, EdgeList* oldpath){
  * 'startVertex', and return the resulting MST: an array of Edges.
  * Returns NULL is 'startVertex' is not valid in 'graph'.
  * Precondition: 'graph' is connected.
+ * Note: should it not be, only the component of 'startVertex' is spanned
+ * and the remaining entries are (-1 -- -1, -1); getMinimumSpanningForest
+ * spans every component.
  */
 Edge* getMSTprim(Graph* graph, int startVertex){
   if(!isValidVertex(graph, startVertex)){
     return NULL;
   }
 
+  CSRGraph* csr = freezeGraph(graph);
+  Edge* mst = getMSTprimCSR(csr, startVertex);
+  deleteCSRGraph(csr);
+  return mst;
+}
+
+/* Same as getMSTprim, but runs on the frozen graph 'graph'. */
+Edge* getMSTprimCSR(CSRGraph* graph, int startVertex){
+  if(startVertex < 0 || startVertex >= graph->numVertices){
+    return NULL;
+  }
+
   Records* records = initRecords(graph, startVertex); 
   // records holds a lot of dynamic memory which need to free later
 
@@ -177,91 +773,474 @@ Edge* getMSTprim(Graph* graph, int startVertex){
     records->finished[u.id] = true;
     if (u.id != startVertex){
       int predId = records->predecessors[u.id];
-      //int weight = findWeight(graph, predId, u.id);
       int weight = u.priority;
-      addTreeEdge(records, records->numTreeEdges, predId, u.id, weight);
+      addTreeEdge(records, records->numTreeEdges, u.id, predId, weight);
     } 
-    Vertex* vertex =  graph->vertices[u.id];
-    EdgeList* adjList = vertex->adjList;
-    while (adjList->edge != NULL){
-      int v = adjList->edge->toVertex;
-      int weightUtoV = adjList->edge->weight;
-      int priorityV = getPriority(records->heap, v);
-      if (!records->finished[v] && weightUtoV < priorityV){//(records->heap->indexMap[v]!= NOTHING)
-        decreasePriority(records->heap, v, weightUtoV);
-      }
-      //*(records->predecessors+v) = u.id;
-      records->predecessors[v] = u.id;
-
-      adjList = adjList->next;
+    // the edges of u are contiguous: no pointer chasing per edge
+    for (int e = graph->offsets[u.id]; e < graph->offsets[u.id+1]; e++){
+      int v = graph->targets[e];
+      int weightUtoV = graph->weights[e];
+      relaxVertex(records, v, weightUtoV, u.id);
     }
   }
 
-
-  // copy to local memory and free the dynamic memory 
-  Edge* result[records->numTreeEdges];
-  for (int i = 0; i++; i < records->numTreeEdges){
-    // result[i] = records->tree[i]; ?
-    result[i]->fromVertex = records->tree[i].fromVertex;
-    result[i]->toVertex = records->tree[i].toVertex;
-    result[i]->weight = records->tree[i].weight;
-  }
-
-  deleteRecords(records);
-
-  return result;
+  return releaseTree(records);
 }
 
 /* Runs Dijkstra's algorithm on Graph 'graph' starting from vertex with ID
  * 'startVertex', and return the resulting distance tree: an array of edges.
  * Returns NULL if 'startVertex' is not valid in 'graph'.
  * Precondition: 'graph' is connected.
+ * Note: should it not be, the entry of every vertex 'id' that cannot be
+ * reached from 'startVertex' is (id -- -1, INT_MAX).
  */
 Edge* getDistanceTreeDijkstra(Graph* graph, int startVertex){
   if(!isValidVertex(graph, startVertex)){
     return NULL;
   }
-  Records* records = initRecords(graph, startVertex); 
-  // records holds a lot of dynamic memory which need to free later
+
+  CSRGraph* csr = freezeGraph(graph);
+  Edge* distTree = getDistanceTreeDijkstraCSR(csr, startVertex);
+  deleteCSRGraph(csr);
+  return distTree;
+}
+
+/* Same as getDistanceTreeDijkstra, but runs on the frozen graph 'graph'. */
+Edge* getDistanceTreeDijkstraCSR(CSRGraph* graph, int startVertex){
+  if(startVertex < 0 || startVertex >= graph->numVertices){
+    return NULL;
+  }
+  Records* records = dijkstraSearch(graph, startVertex, NOTHING);
+  markUnreached(records);
+  return releaseTree(records);
+}
+
+/* Same as getMSTprim, but runs on the packed graph 'graph', decoding the
+ * edges of a vertex as it relaxes them.
+ * Note: 'graph' has the edges of every vertex sorted by "to" vertex, so
+ * among several minimum spanning trees the result may be a different one
+ * than on the graph it was packed from.
+ */
+Edge* getMSTprimPacked(PackedGraph* graph, int startVertex){
+  if(startVertex < 0 || startVertex >= graph->numVertices){
+    return NULL;
+  }
+
+  Records* records = newRecords(graph->numVertices);
+  records->heap = newHeapWithArity(graph->numVertices, HEAP_ARITY);
+  insert(records->heap, 0, startVertex);
+
   while (!isEmpty(records->heap)){
     HeapNode u = extractMin(records->heap);
     records->finished[u.id] = true;
     if (u.id != startVertex){
       int predId = records->predecessors[u.id];
-      //int weight = findWeight(graph, predId, u.id);
-      int weight = u.priority;
-      addTreeEdge(records, records->numTreeEdges, predId, u.id, weight);
-    } 
-    Vertex* vertex =  graph->vertices[u.id];
-    EdgeList* adjList = vertex->adjList;
-    while (adjList->edge != NULL){
-      int v = adjList->edge->toVertex;
-      int weightUtoV = adjList->edge->weight;
-      int priorityV = getPriority(records->heap, v);
-      int priorityU = getPriority(records->heap, u.id);
-      int d = priorityU + weightUtoV;
-      if (!records->finished[v] && d < priorityV){//(records->heap->indexMap[v]!= NOTHING)
-        decreasePriority(records->heap, v, d);
-      }
-      //*(records->predecessors+v) = u.id;
-      records->predecessors[v] = u.id;
+      addTreeEdge(records, records->numTreeEdges, u.id, predId, u.priority);
+    }
+    const unsigned char* pos = graph->bytes + graph->offsets[u.id];
+    const unsigned char* end = graph->bytes + graph->offsets[u.id+1];
+    int v = u.id;
+    int weightUtoV;
+    while (pos < end){
+      pos = readPackedEdge(pos, &v, &weightUtoV);
+      relaxVertex(records, v, weightUtoV, u.id);
+    }
+  }
+
+  return releaseTree(records);
+}
 
-      adjList = adjList->next;
+/* Same as getDistanceTreeDijkstra, but runs on the packed graph 'graph',
+ * decoding the edges of a vertex as it relaxes them.
+ * Note: the distances equal those on the graph 'graph' was packed from, but
+ * as its edges are in a different order, among several shortest paths the
+ * predecessors may pick a different one.
+ */
+Edge* getDistanceTreeDijkstraPacked(PackedGraph* graph, int startVertex){
+  if(startVertex < 0 || startVertex >= graph->numVertices){
+    return NULL;
+  }
+
+  // the same search as dijkstraSearchWith, but for how edges are read
+  Records* records =
+      newDijkstraRecordsFor(graph->numVertices, graph->maxWeight);
+  startDijkstra(records, startVertex);
+  while (!isQueueEmpty(records)){
+    HeapNode u = settleNext(records);
+    const unsigned char* pos = graph->bytes + graph->offsets[u.id];
+    const unsigned char* end = graph->bytes + graph->offsets[u.id+1];
+    int v = u.id;
+    int weight;
+    while (pos < end){
+      pos = readPackedEdge(pos, &v, &weight);
+      relaxVertex(records, v, u.priority + weight, u.id);
     }
   }
 
-  Edge* distTree[records->numTreeEdges];
-  for (int i = 0; i++; i < records->numTreeEdges){
-    // result[i] = records->tree[i]; ?
-    distTree[i]->fromVertex = records->tree[i].fromVertex;
-    distTree[i]->toVertex = records->tree[i].toVertex;
-    distTree[i]->weight = records->tree[i].weight;
+  markUnreached(records);
+  return releaseTree(records);
+}
+
+/* Runs Dijkstra's algorithm on Graph 'graph' from each of the 'numSources'
+ * vertices in 'sources', on 'numThreads' threads at once, and returns the
+ * resulting distance trees: trees[i] is the tree getDistanceTreeDijkstra
+ * returns for sources[i], or NULL if sources[i] is not valid in 'graph'.
+ * If 'numThreads' is not positive, uses one thread per online processor.
+ * Note: every thread keeps its own records and priority queue and reuses
+ * them for all its sources; 'graph' is only read.
+ */
+Edge** getDistanceTreesBatch(Graph* graph, int* sources, int numSources,
+                             int numThreads){
+  CSRGraph* csr = freezeGraph(graph);
+  Edge** trees = getDistanceTreesBatchCSR(csr, sources, numSources,
+                                          numThreads);
+  deleteCSRGraph(csr);
+  return trees;
+}
+
+/* Same as getDistanceTreesBatch, but runs on the frozen graph 'graph'. */
+Edge** getDistanceTreesBatchCSR(CSRGraph* graph, int* sources, int numSources,
+                                int numThreads){
+  BatchJob job;
+  job.graph = graph;
+  job.sources = sources;
+  job.numSources = numSources;
+  job.trees = malloc(sizeof(Edge*)*(numSources > 0 ? numSources : 1));
+  job.distances = NULL;
+  runBatch(&job, numThreads);
+  return job.trees;
+}
+
+/* Frees all memory allocated for 'trees', an array of 'numTrees' distance
+ * trees returned by getDistanceTreesBatch.
+ */
+void deleteDistanceTrees(Edge** trees, int numTrees){
+  for (int i = 0; i < numTrees; i++){
+    free(trees[i]);
   }
+  free(trees);
+}
 
+/* Returns the distances between all pairs of vertices in Graph 'graph' as
+ * a row-major matrix: row 'id' holds the distances from vertex 'id'. Runs
+ * Dijkstra's algorithm from every vertex on 'numThreads' threads at once
+ * (one per online processor if 'numThreads' is not positive), or, for small
+ * dense graphs, the Floyd-Warshall algorithm. If 'fileName' is not NULL,
+ * the matrix is written to the file 'fileName' as numVertices^2 ints in the
+ * byte order of this machine, and stays mapped into memory.
+ * Returns NULL if 'fileName' cannot be created or mapped.
+ */
+DistanceMatrix* getAllPairsDistances(Graph* graph, int numThreads,
+                                     const char* fileName){
+  CSRGraph* csr = freezeGraph(graph);
+  DistanceMatrix* matrix = getAllPairsDistancesCSR(csr, numThreads, fileName);
+  deleteCSRGraph(csr);
+  return matrix;
+}
+
+/* Same as getAllPairsDistances, but runs on the frozen graph 'graph'. */
+DistanceMatrix* getAllPairsDistancesCSR(CSRGraph* graph, int numThreads,
+                                        const char* fileName){
+  int numVertices = graph->numVertices;
+  DistanceMatrix* matrix = newDistanceMatrix(numVertices, fileName);
+  if (matrix == NULL){
+    return NULL;
+  }
+  if (numVertices <= FLOYD_MAX_VERTICES &&
+      (long)graph->numEdges*FLOYD_MIN_DENSITY >=
+      (long)numVertices*numVertices){
+    floydWarshall(graph, matrix);
+    return matrix;
+  }
+
+  BatchJob job;
+  job.graph = graph;
+  job.sources = NULL;
+  job.numSources = numVertices;
+  job.trees = NULL;
+  job.distances = matrix->distances;
+  runBatch(&job, numThreads);
+  return matrix;
+}
+
+/* Returns the distance from vertex 'from' to vertex 'to' in 'matrix', or
+ * INT_MAX if there is no path.
+ * Precondition: 'from' and 'to' are valid in 'matrix'
+ */
+int getMatrixDistance(DistanceMatrix* matrix, int from, int to){
+  return matrix->distances[(size_t)from*matrix->numVertices + to];
+}
+
+/* Frees all memory allocated for 'matrix'. A matrix in a file is unmapped;
+ * the file stays.
+ */
+void deleteDistanceMatrix(DistanceMatrix* matrix){
+  if (matrix == NULL) return;
+  if (matrix->mappedBytes > 0){
+    munmap(matrix->distances, matrix->mappedBytes);
+  }
+  else {
+    free(matrix->distances);
+  }
+  free(matrix);
+}
+
+/* Runs Dijkstra's algorithm on Graph 'graph' from vertex 'source' until the
+ * distance to vertex 'target' is known, and returns a shortest path from
+ * 'source' to 'target':
+ *   [(source -- id_1, w_0), (id_1 -- id_2, w_1), ..., (id_n -- target, w_n)]
+ * Returns NULL if 'source' or 'target' is not valid in 'graph', if 'target'
+ * cannot be reached from 'source', or if 'source' equals 'target'.
+ * Note: this freezes 'graph' and allocates records for all its vertices
+ * first; to answer many queries on one graph, use a PathQuery.
+ */
+EdgeList* getShortestPathDijkstra(Graph* graph, int source, int target){
+  if(!isValidVertex(graph, source) || !isValidVertex(graph, target)){
+    return NULL;
+  }
+
+  CSRGraph* csr = freezeGraph(graph);
+  EdgeList* path = getShortestPathDijkstraCSR(csr, source, target);
+  deleteCSRGraph(csr);
+  return path;
+}
+
+/* Same as getShortestPathDijkstra, but runs on the frozen graph 'graph'. */
+EdgeList* getShortestPathDijkstraCSR(CSRGraph* graph, int source, int target){
+  if(source < 0 || source >= graph->numVertices ||
+     target < 0 || target >= graph->numVertices){
+    return NULL;
+  }
+  Records* records = dijkstraSearch(graph, source, target);
+  EdgeList* path = NULL;
+  if (records->finished[target]){
+    path = makePathTo(records, target);
+  }
   deleteRecords(records);
+  return path;
+}
 
-  return distTree;
+/* Same as getShortestPathDijkstra, but searches from both ends at once:
+ * forward from 'source' in 'graph' and backward from 'target' along the
+ * reversed edges, until the two searches meet. Usually settles far fewer
+ * vertices than a search from 'source' alone.
+ * Note: like getShortestPathDijkstra, this pays O(V + E) per call; use a
+ * PathQuery for many queries.
+ */
+EdgeList* getShortestPathBidirectional(Graph* graph, int source, int target){
+  if(!isValidVertex(graph, source) || !isValidVertex(graph, target)){
+    return NULL;
+  }
 
+  CSRGraph* csr = freezeGraph(graph);
+  CSRGraph* reverse = reverseCSRGraph(csr);
+  EdgeList* path = getShortestPathBidirectionalCSR(csr, reverse, source,
+                                                   target);
+  deleteCSRGraph(reverse);
+  deleteCSRGraph(csr);
+  return path;
+}
+
+/* Same as getShortestPathBidirectional, but runs on the frozen graph 'graph'
+ * whose reversed edges are in 'reverse'.
+ * Precondition: 'reverse' is reverseCSRGraph('graph')
+ */
+EdgeList* getShortestPathBidirectionalCSR(CSRGraph* graph, CSRGraph* reverse,
+                                          int source, int target){
+  if(source < 0 || source >= graph->numVertices ||
+     target < 0 || target >= graph->numVertices || source == target){
+    return NULL;
+  }
+  Records* forward = newHeapRecords(graph->numVertices);
+  Records* backward = newHeapRecords(graph->numVertices);
+  EdgeList* path = bidirectionalSearchWith(graph, reverse, forward, backward,
+                                           source, target);
+  deleteRecords(forward);
+  deleteRecords(backward);
+  return path;
+}
+
+/* Same as getShortestPathDijkstra, but runs an A* search: vertices are
+ * settled in order of their distance from 'source' plus 'heuristic' applied
+ * to them, which steers the search towards 'target'. 'context' is passed on
+ * to every call of 'heuristic'. If 'heuristic' is NULL, euclideanHeuristic
+ * is used with 'graph' as its context.
+ * Note: like getShortestPathDijkstra, this pays O(V + E) per call; use a
+ * PathQuery for many queries.
+ * Precondition: 'heuristic' is consistent: heuristic(u) <= w + heuristic(v)
+ *               for every edge (u -- v, w); finished vertices are never
+ *               reopened
+ */
+EdgeList* getShortestPathAStar(Graph* graph, int source, int target,
+                               DistanceHeuristic heuristic, void* context){
+  if(!isValidVertex(graph, source) || !isValidVertex(graph, target)){
+    return NULL;
+  }
+  if (heuristic == NULL){
+    heuristic = euclideanHeuristic;
+    context = graph;
+  }
+
+  CSRGraph* csr = freezeGraph(graph);
+  EdgeList* path = getShortestPathAStarCSR(csr, source, target, heuristic,
+                                           context);
+  deleteCSRGraph(csr);
+  return path;
+}
+
+/* Same as getShortestPathAStar, but runs on the frozen graph 'graph'.
+ * Precondition: 'heuristic' is not NULL, and consistent
+ */
+EdgeList* getShortestPathAStarCSR(CSRGraph* graph, int source, int target,
+                                  DistanceHeuristic heuristic, void* context){
+  if(source < 0 || source >= graph->numVertices ||
+     target < 0 || target >= graph->numVertices){
+    return NULL;
+  }
+  Records* records = newHeapRecords(graph->numVertices);
+  aStarSearchWith(graph, records, source, target, heuristic, context);
+  EdgeList* path = NULL;
+  if (records->finished[target]){
+    path = makePathTo(records, target);
+  }
+  deleteRecords(records);
+  return path;
+}
+
+/* Creates and returns a workspace for shortest path queries on 'graph',
+ * which is frozen once here. Each query through it costs only as much as
+ * the vertices it touches, instead of the O(V + E) that freezing and fresh
+ * records add to getShortestPathDijkstra and its siblings.
+ * Returns NULL if 'graph' is NULL.
+ * Note: 'graph' must not change while the query is in use.
+ */
+PathQuery* newPathQuery(Graph* graph){
+  if (graph == NULL){
+    return NULL;
+  }
+  PathQuery* query = newPathQueryCSR(freezeGraph(graph));
+  query->original = graph;
+  query->ownsGraph = true;
+  return query;
+}
+
+/* Same as newPathQuery, but for the frozen graph 'graph', which is shared,
+ * not copied, and must outlive the query.
+ */
+PathQuery* newPathQueryCSR(CSRGraph* graph){
+  if (graph == NULL){
+    return NULL;
+  }
+  PathQuery* query = malloc(sizeof(PathQuery));
+  query->graph = graph;
+  query->reverse = NULL;
+  query->original = NULL;
+  query->ownsGraph = false;
+  query->dijkstra = NULL;
+  query->forward = NULL;
+  query->backward = NULL;
+  return query;
+}
+
+/* Returns true iff 'source' and 'target' are both valid in the graph of
+ * 'query'.
+ */
+bool isValidQuery(PathQuery* query, int source, int target){
+  int numVertices = query->graph->numVertices;
+  return source >= 0 && source < numVertices &&
+         target >= 0 && target < numVertices;
+}
+
+/* Same as getShortestPathDijkstra, on the graph of 'query'. */
+EdgeList* queryPathDijkstra(PathQuery* query, int source, int target){
+  if (!isValidQuery(query, source, target)){
+    return NULL;
+  }
+  if (query->dijkstra == NULL){
+    query->dijkstra = newDijkstraRecords(query->graph);
+  }
+  Records* records = query->dijkstra;
+  resetRecords(records);
+  dijkstraSearchWith(query->graph, records, source, target);
+  if (!records->finished[target]){
+    return NULL;
+  }
+  return makePathTo(records, target);
+}
+
+/* Same as getShortestPathBidirectional, on the graph of 'query'. */
+EdgeList* queryPathBidirectional(PathQuery* query, int source, int target){
+  if (!isValidQuery(query, source, target) || source == target){
+    return NULL;
+  }
+  int numVertices = query->graph->numVertices;
+  if (query->forward == NULL){
+    query->forward = newHeapRecords(numVertices);
+  }
+  if (query->backward == NULL){
+    query->reverse = reverseCSRGraph(query->graph);
+    query->backward = newHeapRecords(numVertices);
+  }
+  resetRecords(query->forward);
+  resetRecords(query->backward);
+  return bidirectionalSearchWith(query->graph, query->reverse, query->forward,
+                                 query->backward, source, target);
+}
+
+/* Same as getShortestPathAStar, on the graph of 'query'. If 'heuristic' is
+ * NULL, euclideanHeuristic is used with the graph 'query' was created from
+ * as its context.
+ * Precondition: 'heuristic' is consistent, as for getShortestPathAStar
+ *               'heuristic' is not NULL if 'query' came from newPathQueryCSR
+ */
+EdgeList* queryPathAStar(PathQuery* query, int source, int target,
+                         DistanceHeuristic heuristic, void* context){
+  if (!isValidQuery(query, source, target)){
+    return NULL;
+  }
+  if (heuristic == NULL){
+    heuristic = euclideanHeuristic;
+    context = query->original;
+  }
+  if (query->forward == NULL){
+    query->forward = newHeapRecords(query->graph->numVertices);
+  }
+  Records* records = query->forward;
+  resetRecords(records);
+  aStarSearchWith(query->graph, records, source, target, heuristic, context);
+  if (!records->finished[target]){
+    return NULL;
+  }
+  return makePathTo(records, target);
+}
+
+/* Frees all memory of 'query', and its frozen graph if it made it. */
+void deletePathQuery(PathQuery* query){
+  if (query->dijkstra != NULL) deleteRecords(query->dijkstra);
+  if (query->forward != NULL) deleteRecords(query->forward);
+  if (query->backward != NULL) deleteRecords(query->backward);
+  if (query->reverse != NULL) deleteCSRGraph(query->reverse);
+  if (query->ownsGraph) deleteCSRGraph(query->graph);
+  free(query);
+}
+
+/* A DistanceHeuristic for graphs embedded in the plane: returns the
+ * straight-line distance, rounded down, between the Coordinates stored in
+ * the values of vertices 'vertex' and 'target' of the Graph 'context'.
+ * Returns 0 if either vertex has no value.
+ * Note: this is consistent only if no edge weighs less than the
+ * straight-line distance between its ends.
+ */
+int euclideanHeuristic(int vertex, int target, void* context){
+  Graph* graph = context;
+  Vertex* from = graph->vertices[vertex];
+  Vertex* to = graph->vertices[target];
+  if (from == NULL || to == NULL || from->value == NULL || to->value == NULL){
+    return 0;
+  }
+  Coordinates* a = from->value;
+  Coordinates* b = to->value;
+  return (int)floor(hypot(a->x - b->x, a->y - b->y));
 }
 
 /* Creates and returns an array 'paths' of shortest paths from every vertex
@@ -274,21 +1253,184 @@ Edge* getDistanceTreeDijkstra(Graph* graph, int startVertex){
  * Returns NULL if 'startVertex' is not valid in 'distTree'.
  */
 EdgeList** getShortestPaths(Edge* distTree, int numVertices, int startVertex){
-  if(distTree->fromVertex != startVertex){
+  if(distTree == NULL || startVertex < 0 || startVertex >= numVertices ||
+     distTree[startVertex].toVertex != startVertex){
     return NULL;
   }
 
-  EdgeList*  paths[numVertices]; // an array of path
+  // one block holds the array, one EdgeList node and one Edge per vertex:
+  // paths[id] is the node of id followed by the path of its predecessor,
+  // so every path shares its tail with the paths of the vertices on it
+  size_t bytes = numVertices*(sizeof(EdgeList*) + sizeof(EdgeList) +
+                              sizeof(Edge));
+  EdgeList** paths = malloc(bytes);
+  EdgeList* nodes = (EdgeList*)(paths + numVertices);
+  Edge* edges = (Edge*)(nodes + numVertices);
+  bool* built = calloc(numVertices, sizeof(bool));
+  int* pending = malloc(sizeof(int)*numVertices);
 
+  paths[startVertex] = NULL;
+  built[startVertex] = true;
   for(int i=0; i<numVertices; i++){
-    if(i != startVertex){
-      EdgeList * path = makePath(distTree, i, startVertex);
-      copyPath(paths[i], path);
-      deleteEdgeList(path);
+    // walk up the predecessors to a vertex whose path is built, then build
+    // the paths on the way back down; every vertex is built once
+    int numPending = 0;
+    int v = i;
+    while(!built[v] && distTree[v].toVertex != NOTHING){  // reached
+      pending[numPending++] = v;
+      v = distTree[v].toVertex;
+    }
+    if(!built[v]){  // unreached vertices have no path
+      paths[v] = NULL;
+      built[v] = true;
+    }
+    while(numPending > 0){
+      v = pending[--numPending];
+      int predId = distTree[v].toVertex;
+      edges[v].fromVertex = v;
+      edges[v].toVertex = predId;
+      edges[v].weight = distTree[v].weight - distTree[predId].weight;
+      nodes[v].edge = &edges[v];
+      nodes[v].next = paths[predId];
+      paths[v] = &nodes[v];
+      built[v] = true;
     }
   }
+
+  free(built);
+  free(pending);
   return paths;
+}
+
+/* Frees all memory allocated for 'paths', an array of 'numVertices' paths
+ * returned by getShortestPaths.
+ */
+void deletePaths(EdgeList** paths, int numVertices){
+  (void)numVertices;  // everything is in one block
+  free(paths);
+}
+/* Runs Dijkstra's algorithm on Graph 'graph' starting from vertex with ID
+ * 'startVertex', and returns the shortest paths from every vertex to
+ * 'startVertex', without building any of them: use distanceTo, pathLength
+ * and pathIterator to read them.
+ * Returns NULL if 'startVertex' is not valid in 'graph'.
+ */
+ShortestPaths* getShortestPathTree(Graph* graph, int startVertex){
+  Edge* distTree = getDistanceTreeDijkstra(graph, startVertex);
+  if (distTree == NULL){
+    return NULL;
+  }
+  return newShortestPaths(distTree, graph->numVertices, startVertex);
+}
+
+/* Same as getShortestPathTree, but runs on the frozen graph 'graph'. */
+ShortestPaths* getShortestPathTreeCSR(CSRGraph* graph, int startVertex){
+  Edge* distTree = getDistanceTreeDijkstraCSR(graph, startVertex);
+  if (distTree == NULL){
+    return NULL;
+  }
+  return newShortestPaths(distTree, graph->numVertices, startVertex);
+}
 
+/* Returns a newly created ShortestPaths that takes over the distance tree
+ * 'distTree' produced by Dijkstra's algorithm on a graph with 'numVertices'
+ * vertices and with the start vertex 'startVertex'. 'distTree' is freed
+ * with the result.
+ * Returns NULL if 'startVertex' is not valid in 'distTree'.
+ */
+ShortestPaths* newShortestPaths(Edge* distTree, int numVertices,
+                                int startVertex){
+  if(distTree == NULL || startVertex < 0 || startVertex >= numVertices ||
+     distTree[startVertex].toVertex != startVertex){
+    return NULL;
+  }
+  ShortestPaths* paths = malloc(sizeof(ShortestPaths));
+  paths->numVertices = numVertices;
+  paths->startVertex = startVertex;
+  paths->distTree = distTree;
+  paths->pathLengths = NULL;
+  return paths;
+}
+
+/* Returns the distance from vertex 'vertex' to the start vertex of 'paths',
+ * or INT_MAX if there is no path.
+ * Precondition: 'vertex' is valid in 'paths'
+ */
+int distanceTo(ShortestPaths* paths, int vertex){
+  return paths->distTree[vertex].weight;
+}
+
+/* Returns the number of edges on the path from vertex 'vertex' to the start
+ * vertex of 'paths', or -1 if there is no path.
+ * Note: the first call computes the lengths of all paths, in
+ * O(numVertices) time.
+ * Precondition: 'vertex' is valid in 'paths'
+ */
+int pathLength(ShortestPaths* paths, int vertex){
+  if (paths->pathLengths == NULL){
+    // as in getShortestPaths: the length of a path is one more than that of
+    // the predecessor's path, so fill them in predecessors first
+    int numVertices = paths->numVertices;
+    Edge* distTree = paths->distTree;
+    int* lengths = malloc(sizeof(int)*numVertices);
+    int* pending = malloc(sizeof(int)*numVertices);
+    for (int i = 0; i < numVertices; i++){
+      lengths[i] = distTree[i].toVertex == NOTHING ? NOTHING : UNREACHED;
+    }
+    lengths[paths->startVertex] = 0;
+    for (int i = 0; i < numVertices; i++){
+      int numPending = 0;
+      int v = i;
+      while (lengths[v] == UNREACHED){  // reached, but length not known yet
+        pending[numPending++] = v;
+        v = distTree[v].toVertex;
+      }
+      while (numPending > 0){
+        v = pending[--numPending];
+        lengths[v] = lengths[distTree[v].toVertex] + 1;
+      }
+    }
+    free(pending);
+    paths->pathLengths = lengths;
+  }
+  return paths->pathLengths[vertex];
+}
+
+/* Returns an iterator over the edges of the path from vertex 'vertex' to
+ * the start vertex of 'paths'; see nextPathEdge.
+ * Precondition: 'vertex' is valid in 'paths'
+ */
+PathIterator pathIterator(ShortestPaths* paths, int vertex){
+  PathIterator iterator = {paths, vertex};
+  return iterator;
+}
+
+/* Stores the next edge of the path walked by 'iterator' in '*edge' and
+ * returns true, or returns false if the path has no more edges. The edges
+ * come in the order of getShortestPaths:
+ *   (id -- id_1, w_0), (id_1 -- id_2, w_1), ..., (id_n -- start, w_n)
+ */
+bool nextPathEdge(PathIterator* iterator, Edge* edge){
+  Edge* distTree = iterator->paths->distTree;
+  int v = iterator->vertex;
+  int predId = distTree[v].toVertex;
+  if (v == iterator->paths->startVertex || predId == NOTHING){
+    return false;
+  }
+  edge->fromVertex = v;
+  edge->toVertex = predId;
+  edge->weight = distTree[v].weight - distTree[predId].weight;
+  iterator->vertex = predId;
+  return true;
+}
+
+/* Frees all memory allocated for 'paths', including its distance tree.
+ */
+void deleteShortestPaths(ShortestPaths* paths){
+  if (paths == NULL) return;
+  free(paths->distTree);
+  free(paths->pathLengths);
+  free(paths);
 }
 
 
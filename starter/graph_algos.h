@@ -16,10 +16,65 @@
 #ifndef __Graph_Algos_header
 #define __Graph_Algos_header
 
+/* Returns a lower bound on the distance from vertex 'vertex' to vertex
+ * 'target', to guide an A* search; 'context' is whatever the caller passed
+ * to the search. The bound must be consistent: for every edge (u -- v, w),
+ * h(u) <= w + h(v), and h(target) = 0.
+ */
+typedef int (*DistanceHeuristic)(int vertex, int target, void* context);
+
+typedef struct coordinates {  // position of a vertex in the plane
+  double x;
+  double y;
+} Coordinates;
+
+typedef struct shortest_paths {  // all shortest paths from one vertex
+  int numVertices;   // total number of vertices in the graph
+  int startVertex;   // the vertex all paths lead to
+  Edge* distTree;    // distance tree from Dijkstra's algorithm: distTree[id]
+                     //   is (id -- predecessor of id, distance(id))
+  int* pathLengths;  // pathLengths[id] is the number of edges on the path
+                     //   of id; NULL until pathLength is first called
+} ShortestPaths;
+
+typedef struct path_iterator {  // walks one path of a ShortestPaths
+  ShortestPaths* paths;  // the paths being walked
+  int vertex;            // the vertex the next edge leaves from
+} PathIterator;
+
+typedef struct distance_matrix {  // distances between all pairs of vertices
+  int numVertices;     // total number of vertices in the graph
+  int* distances;      // distances[from*numVertices + to] is the distance
+                       //   from vertex from to vertex to, or INT_MAX if
+                       //   there is no path
+  size_t mappedBytes;  // size of the file mapping that holds 'distances',
+                       //   or 0 if it is not in a file
+} DistanceMatrix;
+
+typedef struct path_query {  // reusable workspace for shortest path queries
+  CSRGraph* graph;        // the frozen graph the queries run on
+  CSRGraph* reverse;      // its reversed edges, or NULL until a
+                          //   bidirectional query first needs them
+  Graph* original;        // the graph 'graph' was frozen from, the context
+                          //   of euclideanHeuristic; NULL if not known
+  bool ownsGraph;         // true iff 'graph' is freed with the query
+  struct records* dijkstra;  // workspace of Dijkstra queries
+  struct records* forward;   // workspace of A* queries and of the source
+                             //   side of bidirectional queries
+  struct records* backward;  // workspace of the target side of
+                             //   bidirectional queries; all three are
+                             //   created when first needed and reused,
+                             //   clearing only the vertices the last
+                             //   query touched
+} PathQuery;
+
 /* Runs Prim's algorithm on Graph 'graph' starting from vertex with ID
  * 'startVertex', and return the resulting MST: an array of Edges.
  * Returns NULL is 'startVertex' is not valid in 'graph'.
  * Precondition: 'graph' is connected.
+ * Note: should it not be, only the component of 'startVertex' is spanned
+ * and the remaining entries are (-1 -- -1, -1); getMinimumSpanningForest
+ * spans every component.
  */
 Edge* getMSTprim(Graph* graph, int startVertex);
 
@@ -27,9 +82,174 @@ Edge* getMSTprim(Graph* graph, int startVertex);
  * 'startVertex', and return the resulting distance tree: an array of edges.
  * Returns NULL if 'startVertex' is not valid in 'graph'.
  * Precondition: 'graph' is connected.
+ * Note: should it not be, the entry of every vertex 'id' that cannot be
+ * reached from 'startVertex' is (id -- -1, INT_MAX).
  */
 Edge* getDistanceTreeDijkstra(Graph* graph, int startVertex);
 
+/* Same as getMSTprim, but runs on the frozen graph 'graph'. */
+Edge* getMSTprimCSR(CSRGraph* graph, int startVertex);
+
+/* Same as getDistanceTreeDijkstra, but runs on the frozen graph 'graph'. */
+Edge* getDistanceTreeDijkstraCSR(CSRGraph* graph, int startVertex);
+
+/* Same as getMSTprim, but runs on the packed graph 'graph', decoding the
+ * edges of a vertex as it relaxes them.
+ * Note: 'graph' has the edges of every vertex sorted by "to" vertex, so
+ * among several minimum spanning trees the result may be a different one
+ * than on the graph it was packed from.
+ */
+Edge* getMSTprimPacked(PackedGraph* graph, int startVertex);
+
+/* Same as getDistanceTreeDijkstra, but runs on the packed graph 'graph',
+ * decoding the edges of a vertex as it relaxes them.
+ * Note: the distances equal those on the graph 'graph' was packed from, but
+ * as its edges are in a different order, among several shortest paths the
+ * predecessors may pick a different one.
+ */
+Edge* getDistanceTreeDijkstraPacked(PackedGraph* graph, int startVertex);
+
+/* Runs Dijkstra's algorithm on Graph 'graph' from each of the 'numSources'
+ * vertices in 'sources', on 'numThreads' threads at once, and returns the
+ * resulting distance trees: trees[i] is the tree getDistanceTreeDijkstra
+ * returns for sources[i], or NULL if sources[i] is not valid in 'graph'.
+ * If 'numThreads' is not positive, uses one thread per online processor.
+ * Note: every thread keeps its own records and priority queue and reuses
+ * them for all its sources; 'graph' is only read.
+ */
+Edge** getDistanceTreesBatch(Graph* graph, int* sources, int numSources,
+                             int numThreads);
+
+/* Same as getDistanceTreesBatch, but runs on the frozen graph 'graph'. */
+Edge** getDistanceTreesBatchCSR(CSRGraph* graph, int* sources, int numSources,
+                                int numThreads);
+
+/* Frees all memory allocated for 'trees', an array of 'numTrees' distance
+ * trees returned by getDistanceTreesBatch.
+ */
+void deleteDistanceTrees(Edge** trees, int numTrees);
+
+/* Returns the distances between all pairs of vertices in Graph 'graph' as
+ * a row-major matrix: row 'id' holds the distances from vertex 'id'. Runs
+ * Dijkstra's algorithm from every vertex on 'numThreads' threads at once
+ * (one per online processor if 'numThreads' is not positive), or, for small
+ * dense graphs, the Floyd-Warshall algorithm. If 'fileName' is not NULL,
+ * the matrix is written to the file 'fileName' as numVertices^2 ints in the
+ * byte order of this machine, and stays mapped into memory.
+ * Returns NULL if 'fileName' cannot be created or mapped.
+ */
+DistanceMatrix* getAllPairsDistances(Graph* graph, int numThreads,
+                                     const char* fileName);
+
+/* Same as getAllPairsDistances, but runs on the frozen graph 'graph'. */
+DistanceMatrix* getAllPairsDistancesCSR(CSRGraph* graph, int numThreads,
+                                        const char* fileName);
+
+/* Returns the distance from vertex 'from' to vertex 'to' in 'matrix', or
+ * INT_MAX if there is no path.
+ * Precondition: 'from' and 'to' are valid in 'matrix'
+ */
+int getMatrixDistance(DistanceMatrix* matrix, int from, int to);
+
+/* Frees all memory allocated for 'matrix'. A matrix in a file is unmapped;
+ * the file stays.
+ */
+void deleteDistanceMatrix(DistanceMatrix* matrix);
+
+/* Runs Dijkstra's algorithm on Graph 'graph' from vertex 'source' until the
+ * distance to vertex 'target' is known, and returns a shortest path from
+ * 'source' to 'target':
+ *   [(source -- id_1, w_0), (id_1 -- id_2, w_1), ..., (id_n -- target, w_n)]
+ * where w_0 + w_1 + ... + w_n = distance(target). Only the vertices closer
+ * to 'source' than 'target' are settled.
+ * Returns NULL if 'source' or 'target' is not valid in 'graph', if 'target'
+ * cannot be reached from 'source', or if 'source' equals 'target'.
+ * Note: this freezes 'graph' and allocates records for all its vertices
+ * first; to answer many queries on one graph, use a PathQuery.
+ */
+EdgeList* getShortestPathDijkstra(Graph* graph, int source, int target);
+
+/* Same as getShortestPathDijkstra, but runs on the frozen graph 'graph'. */
+EdgeList* getShortestPathDijkstraCSR(CSRGraph* graph, int source, int target);
+
+/* Same as getShortestPathDijkstra, but searches from both ends at once:
+ * forward from 'source' in 'graph' and backward from 'target' along the
+ * reversed edges, until the two searches meet. Usually settles far fewer
+ * vertices than a search from 'source' alone.
+ * Note: like getShortestPathDijkstra, this pays O(V + E) per call; use a
+ * PathQuery for many queries.
+ */
+EdgeList* getShortestPathBidirectional(Graph* graph, int source, int target);
+
+/* Same as getShortestPathBidirectional, but runs on the frozen graph 'graph'
+ * whose reversed edges are in 'reverse'; build 'reverse' once to answer
+ * many queries.
+ * Precondition: 'reverse' is reverseCSRGraph('graph')
+ */
+EdgeList* getShortestPathBidirectionalCSR(CSRGraph* graph, CSRGraph* reverse,
+                                          int source, int target);
+
+/* Same as getShortestPathDijkstra, but runs an A* search: vertices are
+ * settled in order of their distance from 'source' plus 'heuristic' applied
+ * to them, which steers the search towards 'target'. 'context' is passed on
+ * to every call of 'heuristic'. If 'heuristic' is NULL, euclideanHeuristic
+ * is used with 'graph' as its context.
+ * Note: like getShortestPathDijkstra, this pays O(V + E) per call; use a
+ * PathQuery for many queries.
+ * Precondition: 'heuristic' is consistent: heuristic(u) <= w + heuristic(v)
+ *               for every edge (u -- v, w); finished vertices are never
+ *               reopened
+ */
+EdgeList* getShortestPathAStar(Graph* graph, int source, int target,
+                               DistanceHeuristic heuristic, void* context);
+
+/* Same as getShortestPathAStar, but runs on the frozen graph 'graph'.
+ * Precondition: 'heuristic' is not NULL, and consistent
+ */
+EdgeList* getShortestPathAStarCSR(CSRGraph* graph, int source, int target,
+                                  DistanceHeuristic heuristic, void* context);
+
+/* Creates and returns a workspace for shortest path queries on 'graph',
+ * which is frozen once here. Each query through it costs only as much as
+ * the vertices it touches, instead of the O(V + E) that freezing and fresh
+ * records add to getShortestPathDijkstra and its siblings.
+ * Returns NULL if 'graph' is NULL.
+ * Note: 'graph' must not change while the query is in use.
+ */
+PathQuery* newPathQuery(Graph* graph);
+
+/* Same as newPathQuery, but for the frozen graph 'graph', which is shared,
+ * not copied, and must outlive the query.
+ */
+PathQuery* newPathQueryCSR(CSRGraph* graph);
+
+/* Same as getShortestPathDijkstra, on the graph of 'query'. */
+EdgeList* queryPathDijkstra(PathQuery* query, int source, int target);
+
+/* Same as getShortestPathBidirectional, on the graph of 'query'. */
+EdgeList* queryPathBidirectional(PathQuery* query, int source, int target);
+
+/* Same as getShortestPathAStar, on the graph of 'query'. If 'heuristic' is
+ * NULL, euclideanHeuristic is used with the graph 'query' was created from
+ * as its context.
+ * Precondition: 'heuristic' is consistent, as for getShortestPathAStar
+ *               'heuristic' is not NULL if 'query' came from newPathQueryCSR
+ */
+EdgeList* queryPathAStar(PathQuery* query, int source, int target,
+                         DistanceHeuristic heuristic, void* context);
+
+/* Frees all memory of 'query', and its frozen graph if it made it. */
+void deletePathQuery(PathQuery* query);
+
+/* A DistanceHeuristic for graphs embedded in the plane: returns the
+ * straight-line distance, rounded down, between the Coordinates stored in
+ * the values of vertices 'vertex' and 'target' of the Graph 'context'.
+ * Returns 0 if either vertex has no value.
+ * Note: this is consistent only if no edge weighs less than the
+ * straight-line distance between its ends.
+ */
+int euclideanHeuristic(int vertex, int target, void* context);
+
 /* Creates and returns an array 'paths' of shortest paths from every vertex
  * in the graph to vertex 'startVertex', based on the information in the
  * distance tree 'distTree' produced by Dijkstra's algorithm on a graph with
@@ -38,7 +258,65 @@ Edge* getDistanceTreeDijkstra(Graph* graph, int startVertex);
  *   [(id -- id_1, w_0), (id_1 -- id_2, w_1), ..., (id_n -- start, w_n)]
  *   where w_0 + w_1 + ... + w_n = distance(id)
  * Returns NULL if 'startVertex' is not valid in 'distTree'.
+ * Note: the paths share their common tails, so they must be freed with
+ * deletePaths and not one by one. Takes O(numVertices) time and memory.
  */
 EdgeList** getShortestPaths(Edge* distTree, int numVertices, int startVertex);
 
+/* Frees all memory allocated for 'paths', an array of 'numVertices' paths
+ * returned by getShortestPaths.
+ */
+void deletePaths(EdgeList** paths, int numVertices);
+
+/* Runs Dijkstra's algorithm on Graph 'graph' starting from vertex with ID
+ * 'startVertex', and returns the shortest paths from every vertex to
+ * 'startVertex', without building any of them: use distanceTo, pathLength
+ * and pathIterator to read them.
+ * Returns NULL if 'startVertex' is not valid in 'graph'.
+ */
+ShortestPaths* getShortestPathTree(Graph* graph, int startVertex);
+
+/* Same as getShortestPathTree, but runs on the frozen graph 'graph'. */
+ShortestPaths* getShortestPathTreeCSR(CSRGraph* graph, int startVertex);
+
+/* Returns a newly created ShortestPaths that takes over the distance tree
+ * 'distTree' produced by Dijkstra's algorithm on a graph with 'numVertices'
+ * vertices and with the start vertex 'startVertex'. 'distTree' is freed
+ * with the result.
+ * Returns NULL if 'startVertex' is not valid in 'distTree'.
+ */
+ShortestPaths* newShortestPaths(Edge* distTree, int numVertices,
+                                int startVertex);
+
+/* Returns the distance from vertex 'vertex' to the start vertex of 'paths',
+ * or INT_MAX if there is no path.
+ * Precondition: 'vertex' is valid in 'paths'
+ */
+int distanceTo(ShortestPaths* paths, int vertex);
+
+/* Returns the number of edges on the path from vertex 'vertex' to the start
+ * vertex of 'paths', or -1 if there is no path.
+ * Note: the first call computes the lengths of all paths, in
+ * O(numVertices) time.
+ * Precondition: 'vertex' is valid in 'paths'
+ */
+int pathLength(ShortestPaths* paths, int vertex);
+
+/* Returns an iterator over the edges of the path from vertex 'vertex' to
+ * the start vertex of 'paths'; see nextPathEdge.
+ * Precondition: 'vertex' is valid in 'paths'
+ */
+PathIterator pathIterator(ShortestPaths* paths, int vertex);
+
+/* Stores the next edge of the path walked by 'iterator' in '*edge' and
+ * returns true, or returns false if the path has no more edges. The edges
+ * come in the order of getShortestPaths:
+ *   (id -- id_1, w_0), (id_1 -- id_2, w_1), ..., (id_n -- start, w_n)
+ */
+bool nextPathEdge(PathIterator* iterator, Edge* edge);
+
+/* Frees all memory allocated for 'paths', including its distance tree.
+ */
+void deleteShortestPaths(ShortestPaths* paths);
+
 #endif
@@ -6,10 +6,13 @@
  *
  *  ---------------------------------------------------------------------------
  *   Compile:
- *   gcc -Wall -Werror graph.c minheap.c graph_algos.c graph_tester.c -o tester
+ *   gcc -Wall -Werror graph.c minheap.c bucketqueue.c graph_algos.c \
+ *       contraction.c landmarks.c deltastep.c multiqueue.c mst.c \
+ *       graph_tester.c -o tester -lm -pthread
  *
  *   Run:
  *   ./tester sample_input.txt
+ *   ./tester sample_input.txt --check   (also checks the other algorithms)
  *
  *   SEE FILE expected_output.txt FOR EXPECTED OUTPUT
  *
@@ -20,22 +23,95 @@
  *  ---------------------------------------------------------------------------
  */
 
+#include <limits.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include "contraction.h"
+#include "deltastep.h"
 #include "graph.h"
 #include "graph_algos.h"
+#include "landmarks.h"
 #include "minheap.h"
+#include "mst.h"
+#include "multiqueue.h"
 
-#define MAX_LIMIT 1024
+#define PARSE_CHUNK_MIN (1 << 20)  // bytes of input per parsing thread, at
+                                   //   least
+#define CHECK_CHUNKS 4     // most chunks in the parsing checks
+#define CHECK_NODES 2000   // nodes in the MultiQueue checks
+#define CHECK_HEAPS 4      // heaps in the MultiQueue checks
+#define CHECK_SOURCES 8    // start vertices per graph in the distance checks
+#define CHECK_LANDMARKS 4  // landmarks in the ALT checks
+#define CHECK_MAX_VERTICES 2000  // all-pairs, spanning forest and path
+                                 //   query checks are skipped on larger
+                                 //   graphs
+#define CHECK_EXTRA_VERTICES 3   // vertices added in the spanning forest
+                                 //   checks
+// a small directed graph for the checks: no edge has a reverse of the same
+// weight, 2 -- 1 has a parallel edge, 3 -- 3 is a loop, 4 -- 3 weighs 0, and
+// no vertex reaches 6
+#define CHECK_GRAPH                                                    \
+  "7\n0 1 4 2 1\n1 3 2 0 7\n2 1 1 3 7 4 3 1 5\n3 5 1 3 2\n4 3 0 5 6\n" \
+  "5 0 9 2 2\n6 0 2 5 1\n"
+
+typedef struct scanner {  // reads integers from the text of an input file
+  const char* pos;  // the next character to read
+  const char* end;  // one past the last character
+  char error[80];   // why the last read failed, if it did
+} Scanner;
+
+typedef struct parse_chunk {  // the lines of an input file one thread parses
+  Scanner scanner;     // the lines, whole lines only
+  int numVertices;     // number of vertices in the graph
+  Graph* nodes;        // owns the nodes parsed so far, in its arena; has no
+                       //   vertices of its own, but counts the edges; NULL
+                       //   when parsing into 'arcs' instead
+  Vertex** vertices;   // the vertices parsed so far, in order of their lines
+  int* lines;          // without 'nodes': (id, end in 'arcs') of every line
+                       //   parsed so far, in order
+  int* arcs;           // without 'nodes': (target, weight) of every edge
+                       //   parsed so far, in order
+  int numArcs;         // number of edges in 'arcs'
+  int arcCapacity;     // number of edges 'arcs' has room for
+  int numLines;        // number of vertices in 'vertices' or 'lines'
+  int capacity;        // number of vertices 'vertices' or 'lines' has room
+                       //   for
+  bool failed;         // true iff a line could not be parsed
+} ParseChunk;
+
+typedef struct drain {  // one thread emptying a MultiQueue, with --check
+  MultiQueue* queue;    // the queue
+  HeapNode* nodes;      // the nodes this thread extracted, in order
+  int numNodes;         // number of nodes in 'nodes'
+} Drain;
 
 /* functions to create a Graph from a file */
 Graph* createGraph(FILE* f);
-int readVertexID(char* token, int numVertices);
-int readWeight(char* token);
-EdgeList* addEdge(EdgeList* head, int fromVertex, int toVertex, int weight);
-bool updateVertex(Graph* graph, char* line);
+CSRGraph* createCSRGraph(FILE* f);
+bool loadInput(FILE* f, Graph** graph, CSRGraph** csr);
+char* mapInput(FILE* f, size_t* size, bool* mapped);
+ParseChunk* splitLines(int numVertices, bool compact, const char* text,
+                       const char* end, int* numChunks);
+bool parseLines(Graph* graph, const char* text, const char* end,
+                int numChunks);
+CSRGraph* parseLinesCSR(int numVertices, const char* text, const char* end,
+                        int numChunks);
+void* parseChunk(void* arg);
+bool scanInt(Scanner* scanner, int* value);
+bool atLineEnd(Scanner* scanner);
+bool skipBlankLines(Scanner* scanner);
+int readVertexID(Scanner* scanner, int numVertices);
+int readWeight(Scanner* scanner);
+EdgeList* addEdge(Graph* graph, EdgeList* head, int fromVertex, int toVertex,
+                  int weight);
+bool updateVertex(ParseChunk* chunk);
+bool appendArc(ParseChunk* chunk, int toVertex, int weight);
 
 /* run and print */
 void runPrim(Graph* graph, int startVertex);
@@ -43,8 +119,38 @@ void runDijkstra(Graph* graph, int startVertex);
 int printTree(Edge* mst, int numTreeEdges);
 void printPaths(EdgeList** paths, int numVertices);
 
-/* cleanup */
-void freePaths(EdgeList** paths, int numVertices);
+/* check the other algorithms, with --check */
+int runChecks(Graph* graph, const char* fileName);
+bool reportCheck(const char* name, const char* graphName, bool passed);
+FILE* openCheckInput(const char* fileName);
+bool checkMultiQueue(void);
+void* drainMultiQueue(void* arg);
+bool checkChunkedParsing(void);
+int checkSource(CSRGraph* csr, int i);
+int numCheckSources(CSRGraph* csr);
+bool hasEdge(CSRGraph* csr, int fromVertex, int toVertex, int weight);
+bool isShortestPath(CSRGraph* csr, EdgeList* path, int source, int target,
+                    int distance);
+bool isDistanceTree(CSRGraph* csr, Edge* tree, Edge* expected, int source);
+bool checkContractionHierarchy(CSRGraph* csr);
+bool checkLandmarks(CSRGraph* csr);
+bool checkPathQuery(Graph* graph, CSRGraph* csr);
+bool checkAllPairs(CSRGraph* csr);
+bool checkDeltaStepping(CSRGraph* csr);
+bool checkDistanceMatrix(CSRGraph* csr, int numThreads, bool inFile);
+CSRGraph* padCSRGraph(CSRGraph* csr, int numExtra);
+bool checkBoruvka(CSRGraph* csr);
+bool checkKruskal(CSRGraph* csr);
+bool checkSpanningForest(CSRGraph* csr);
+CSRGraph* symmetrizeCSRGraph(CSRGraph* csr);
+long spanningTreeWeight(CSRGraph* csr, Edge* tree);
+long forestWeight(Edge* tree, int numEdges);
+bool checkGraphImage(CSRGraph* csr);
+bool isSameCSRGraph(CSRGraph* csr, CSRGraph* other);
+bool checkCompactLoading(CSRGraph* csr, const char* fileName);
+bool checkPackedGraph(CSRGraph* csr);
+bool hasSameEdges(CSRGraph* csr, CSRGraph* sorted);
+int compareEdges(const void* a, const void* b);
 
 int main(int argc, char* argv[]) {
   if (argc == 1) {
@@ -65,8 +171,13 @@ int main(int argc, char* argv[]) {
   runPrim(graph, 0);  // try other vertices!
   runDijkstra(graph, 0);
 
+  int numFailed = 0;
+  if (argc > 2 && strcmp(argv[2], "--check") == 0) {
+    numFailed = runChecks(graph, argv[1]);
+  }
+
   deleteGraph(graph);
-  return 0;
+  return numFailed > 0;
 }
 
 /* Runs Prim's algorithm on 'graph' starting at vertex 'startVertex',
@@ -104,90 +215,471 @@ void runDijkstra(Graph* graph, int startVertex) {
   printf("getShortestPaths from %d produced these paths:\n", startVertex);
   printPaths(paths, graph->numVertices);
 
-  freePaths(paths, graph->numVertices);
-  free(paths);
+  deletePaths(paths, graph->numVertices);
   free(distanceTree);
 }
 
 /* Creates and returns a new Graph from the information in the file 'f'.
+ * Note: the file is mapped into memory and scanned in place, so lines may
+ * be of any length.
  */
 Graph* createGraph(FILE* f) {
-  char line[MAX_LIMIT];
+  Graph* graph = NULL;
+  loadInput(f, &graph, NULL);
+  return graph;
+}
 
-  if (!fgets(line, MAX_LIMIT, f)) {  // read first line
-    printf("Could not read number of vertices from input file. Giving up.\n");
-    return NULL;
+/* Creates and returns a new CSRGraph from the information in the file 'f',
+ * without building a Graph first: the edges go straight into compact
+ * (target, weight) storage, 8 bytes each. The result equals freezeGraph of
+ * createGraph(f), at a fraction of the memory.
+ */
+CSRGraph* createCSRGraph(FILE* f) {
+  CSRGraph* csr = NULL;
+  loadInput(f, NULL, &csr);
+  return csr;
+}
+
+/* Reads the file 'f' into a new Graph, stored in '*graph', if 'graph' is not
+ * NULL, and into a new CSRGraph, stored in '*csr', otherwise. Returns true
+ * iff it succeeded; otherwise prints why, and stores NULL.
+ */
+bool loadInput(FILE* f, Graph** graph, CSRGraph** csr) {
+  if (graph != NULL) *graph = NULL;
+  if (csr != NULL) *csr = NULL;
+  size_t size;
+  bool mapped;
+  char* text = mapInput(f, &size, &mapped);
+  if (text == NULL) {
+    printf("Could not read input file. Giving up.\n");
+    return false;
   }
+  Scanner scanner = {text, text + size, ""};
 
-  int numVertices = atoi(line);  // first line is number of vertices
-  if (numVertices < 0) {
+  bool loaded = false;
+  int numVertices;
+  if (!scanInt(&scanner, &numVertices)) {  // first line
+    if (scanner.error[0] != '\0') {  // scanInt has said why
+      printf("%s", scanner.error);
+    } else {
+      printf("Could not read number of vertices from input file. Giving up.\n");
+    }
+  } else if (numVertices < 0) {
     printf("Number of vertices must be positive. Read: %d. Giving up.\n",
            numVertices);
-    return NULL;
+  } else if (graph == NULL) {
+    skipBlankLines(&scanner);
+    *csr = parseLinesCSR(numVertices, scanner.pos, scanner.end, 0);
+    loaded = *csr != NULL;
+  } else if ((*graph = newArenaGraph(numVertices)) == NULL) {
+    printf("Could not create a new graph. Giving up.\n");
+  } else if (skipBlankLines(&scanner) &&
+             !parseLines(*graph, scanner.pos, scanner.end, 0)) {
+    deleteGraph(*graph);
+    *graph = NULL;
+  } else {
+    loaded = true;
   }
 
-  Graph* graph = newGraph(numVertices);
-  if (graph == NULL) {
-    printf("Could not create a new graph. Giving up.\n");
+  if (mapped) {
+    munmap(text, size);
+  } else {
+    free(text);
+  }
+  return loaded;
+}
+
+/* Returns the contents of the file 'f', from its current position, and
+ * stores their size in '*size'. Maps a regular file into memory and sets
+ * '*mapped'; reads anything else (a pipe, say) into a malloc'ed buffer.
+ * Returns NULL if 'f' cannot be read.
+ */
+char* mapInput(FILE* f, size_t* size, bool* mapped) {
+  struct stat info;
+  long offset = ftell(f);
+  if (offset == 0 && fstat(fileno(f), &info) == 0 && S_ISREG(info.st_mode) &&
+      info.st_size > 0) {
+    char* text = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+    if (text != MAP_FAILED) {
+      madvise(text, info.st_size, MADV_SEQUENTIAL);
+      *size = info.st_size;
+      *mapped = true;
+      return text;
+    }
+  }
+
+  size_t capacity = 1 << 16;
+  size_t used = 0;
+  char* text = malloc(capacity);
+  size_t n;
+  while (text != NULL && (n = fread(text + used, 1, capacity - used, f)) > 0) {
+    used += n;
+    if (used == capacity) {
+      capacity *= 2;
+      char* bigger = realloc(text, capacity);
+      if (bigger == NULL) free(text);
+      text = bigger;
+    }
+  }
+  if (text != NULL && ferror(f)) {
+    free(text);
+    text = NULL;
+  }
+  *size = used;
+  *mapped = false;
+  return text;
+}
+
+/* Splits the lines from 'text' up to 'end', of a graph with 'numVertices'
+ * vertices, into '*numChunks' chunks of whole lines, or if it is not
+ * positive, into one per online processor of at least PARSE_CHUNK_MIN
+ * bytes; parses them on one thread per chunk, and returns the chunks,
+ * storing their number in '*numChunks'. If 'compact' is true, the chunks
+ * keep their edges in 'arcs'; otherwise each has nodes of its own. A chunk
+ * that could not be parsed, or given memory to parse into, is marked
+ * failed.
+ * Returns NULL if there is no memory for the chunks, and prints so.
+ */
+ParseChunk* splitLines(int numVertices, bool compact, const char* text,
+                       const char* end, int* numChunks) {
+  long numThreads = *numChunks;
+  if (numThreads < 1) {
+    numThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (numThreads > (end - text) / PARSE_CHUNK_MIN) {
+      numThreads = (end - text) / PARSE_CHUNK_MIN;
+    }
+    if (numThreads < 1) numThreads = 1;
+  }
+
+  ParseChunk* chunks = malloc(sizeof(ParseChunk) * numThreads);
+  if (chunks == NULL) {
+    printf("Could not allocate the chunks to parse. Giving up.\n");
     return NULL;
   }
+  const char* start = text;
+  for (int i = 0; i < numThreads; i++) {
+    // a chunk ends where a line does, after an even share of the text
+    const char* stop = i == numThreads - 1 ? end
+                       : text + (end - text) / numThreads * (i + 1);
+    while (stop < end && stop > start && stop[-1] != '\n') stop++;
+    if (stop < start) stop = start;
+    chunks[i] = (ParseChunk){{start, stop, ""}, numVertices, NULL, NULL, NULL,
+                             NULL, 0, 0, 0, 0, false};
+    // without nodes of its own, a chunk would parse into 'arcs' instead
+    if (!compact && (chunks[i].nodes = newArenaGraph(0)) == NULL) {
+      printf("Could not allocate a new graph. Giving up.\n");
+      chunks[i].failed = true;
+    }
+    start = stop;
+  }
 
-  while (fgets(line, MAX_LIMIT, f)) {  // read next line
-    if (!updateVertex(graph, line)) {  // update vertex info from line
+  // the calling thread parses the first chunk, and all of them if there is
+  // no memory to start threads
+  pthread_t* threads = malloc(sizeof(pthread_t) * numThreads);
+  bool* started = calloc(numThreads, sizeof(bool));
+  bool spread = threads != NULL && started != NULL;
+  for (int i = 1; i < numThreads && spread; i++) {
+    started[i] =
+        pthread_create(&threads[i], NULL, parseChunk, &chunks[i]) == 0;
+  }
+  parseChunk(&chunks[0]);
+  for (int i = 1; i < numThreads; i++) {
+    if (spread && started[i]) {
+      pthread_join(threads[i], NULL);
+    } else {
+      parseChunk(&chunks[i]);
+    }
+  }
+  free(started);
+  free(threads);
+  *numChunks = numThreads;
+  return chunks;
+}
+
+/* Updates / populates the vertices of 'graph' from the lines from 'text' up
+ * to 'end', parsed by splitLines in 'numChunks' chunks (if positive), each
+ * into nodes of its own; then puts the vertices into 'graph' in order of
+ * their lines. Returns true iff every line was parsed; otherwise prints why
+ * the first bad line failed.
+ */
+bool parseLines(Graph* graph, const char* text, const char* end,
+                int numChunks) {
+  ParseChunk* chunks =
+      splitLines(graph->numVertices, false, text, end, &numChunks);
+  if (chunks == NULL) return false;
+
+  bool parsed = true;
+  for (int i = 0; i < numChunks; i++) {
+    if (parsed && chunks[i].failed) {
+      printf("%s", chunks[i].scanner.error);
       printf("Could not get vertex info from a line. Giving up.\n");
-      deleteGraph(graph);
-      return NULL;
+      parsed = false;
+    }
+    if (parsed) {
+      // a later line for the same vertex replaces an earlier one
+      for (int j = 0; j < chunks[i].numLines; j++) {
+        Vertex* vertex = chunks[i].vertices[j];
+        graph->vertices[vertex->id] = vertex;
+      }
+      graph->numEdges += chunks[i].nodes->numEdges;
     }
+    if (chunks[i].nodes != NULL) mergeArenas(graph, chunks[i].nodes);
+    free(chunks[i].vertices);
   }
-  return graph;
+  free(chunks);
+  return parsed;
+}
+
+/* Returns a new CSRGraph with 'numVertices' vertices, from the lines from
+ * 'text' up to 'end', parsed by splitLines in 'numChunks' chunks (if
+ * positive) into (target, weight) pairs. As
+ * in parseLines, a later line for a vertex replaces an earlier one, and the
+ * edges of a line end up in the order addEdge would have put them in: last
+ * one first. Returns NULL if a line could not be parsed, and prints why the
+ * first bad line failed.
+ */
+CSRGraph* parseLinesCSR(int numVertices, const char* text, const char* end,
+                        int numChunks) {
+  ParseChunk* chunks = splitLines(numVertices, true, text, end, &numChunks);
+  if (chunks == NULL) return NULL;
+
+  // the chunk and the line that has the final say on each vertex
+  int* lastChunk = malloc(sizeof(int) * numVertices);
+  int* lastLine = malloc(sizeof(int) * numVertices);
+  for (int v = 0; v < numVertices; v++) lastChunk[v] = -1;
+  bool parsed = true;
+  for (int i = 0; i < numChunks && parsed; i++) {
+    if (chunks[i].failed) {
+      printf("%s", chunks[i].scanner.error);
+      printf("Could not get vertex info from a line. Giving up.\n");
+      parsed = false;
+    }
+    for (int j = 0; j < chunks[i].numLines && parsed; j++) {
+      lastChunk[chunks[i].lines[2 * j]] = i;
+      lastLine[chunks[i].lines[2 * j]] = j;
+    }
+  }
+
+  CSRGraph* csr = NULL;
+  if (parsed) {
+    // the edges of line j of a chunk are arcs[lines[2j-1] .. lines[2j+1]-1]
+    int numEdges = 0;
+    for (int v = 0; v < numVertices; v++) {
+      if (lastChunk[v] == -1) continue;
+      int* lines = chunks[lastChunk[v]].lines;
+      int j = lastLine[v];
+      numEdges += lines[2 * j + 1] - (j > 0 ? lines[2 * j - 1] : 0);
+    }
+    csr = newCSRGraph(numVertices, numEdges);
+    int e = 0;
+    for (int v = 0; v < numVertices; v++) {
+      csr->offsets[v] = e;
+      if (lastChunk[v] == -1) continue;
+      ParseChunk* chunk = &chunks[lastChunk[v]];
+      int j = lastLine[v];
+      int first = j > 0 ? chunk->lines[2 * j - 1] : 0;
+      for (int a = chunk->lines[2 * j + 1] - 1; a >= first; a--) {
+        csr->targets[e] = chunk->arcs[2 * a];
+        csr->weights[e] = chunk->arcs[2 * a + 1];
+        e++;
+      }
+    }
+    csr->offsets[numVertices] = e;
+    finishCSRGraph(csr);
+  }
+
+  for (int i = 0; i < numChunks; i++) {
+    free(chunks[i].lines);
+    free(chunks[i].arcs);
+  }
+  free(lastChunk);
+  free(lastLine);
+  free(chunks);
+  return csr;
+}
+
+/* Parses the lines of 'arg', a ParseChunk, one vertex per line, until the
+ * last line or the first one that cannot be parsed.
+ */
+void* parseChunk(void* arg) {
+  ParseChunk* chunk = arg;
+  if (chunk->failed) return NULL;  // splitLines has said why
+  Scanner* scanner = &chunk->scanner;
+  // a chunk starts at the start of a line
+  while (scanner->pos < scanner->end && atLineEnd(scanner)) {
+    if (!skipBlankLines(scanner)) break;
+  }
+  while (scanner->pos < scanner->end) {
+    if (!updateVertex(chunk)) {  // update vertex info from line
+      chunk->failed = true;
+      break;
+    }
+    if (!skipBlankLines(scanner)) break;  // next line
+  }
+  return NULL;
+}
+
+/* Reads the next integer on the current line of 'scanner' into '*value',
+ * skipping spaces before it, and returns true. Returns false if the line
+ * has no more integers, or if the next word is not one; or, with the reason
+ * in scanner->error, if it is beyond the range of an int.
+ */
+bool scanInt(Scanner* scanner, int* value) {
+  const char* p = scanner->pos;
+  const char* end = scanner->end;
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    p++;
+  }
+  if (p == end || *p < '0' || *p > '9') {
+    scanner->pos = p;
+    return false;
+  }
+  const char* digits = p;
+  long long result = 0;
+  while (p < end && *p >= '0' && *p <= '9') {
+    if (result <= INT_MAX) result = result * 10 + (*p - '0');
+    p++;
+  }
+  if (negative) result = -result;
+  if (result > INT_MAX || result < INT_MIN) {
+    snprintf(scanner->error, sizeof(scanner->error),
+             "Value out of range: %s%.*s. Giving up.\n", negative ? "-" : "",
+             p - digits > 40 ? 40 : (int)(p - digits), digits);
+    scanner->pos = p;
+    return false;
+  }
+
+  scanner->pos = p;
+  *value = (int)result;
+  return true;
+}
+
+/* Moves 'scanner' past any spaces, and returns true iff that leaves it at
+ * the end of its current line.
+ */
+bool atLineEnd(Scanner* scanner) {
+  const char* p = scanner->pos;
+  while (p < scanner->end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+  scanner->pos = p;
+  return p == scanner->end || *p == '\n';
+}
+
+/* Moves 'scanner' past the end of its current line and past any blank lines
+ * after it. Returns true iff a line with something on it follows.
+ */
+bool skipBlankLines(Scanner* scanner) {
+  const char* p = scanner->pos;
+  const char* end = scanner->end;
+  while (p < end && *p != '\n') p++;  // rest of the current line
+  while (p < end && (*p == '\n' || *p == ' ' || *p == '\t' || *p == '\r')) {
+    p++;
+  }
+  // back to the start of the line, for the next scanInt
+  while (p > scanner->pos && p[-1] != '\n') p--;
+  scanner->pos = p;
+  return p < end;
 }
 
-/* Updates / populates the corresponding vertex in 'graph' using information
- * from the line 'line' in an input file. Returns true iff update was
- * successful.
+/* Parses the vertex on the current line of the scanner of 'chunk', with
+ * its nodes allocated from chunk->nodes, and appends it to chunk->vertices;
+ * or, if 'chunk' has no nodes, appends its edges to chunk->arcs and the line
+ * to chunk->lines. Returns true iff the line was parsed; otherwise the
+ * scanner says why, unless addEdge or appendArc has said it already.
  */
-bool updateVertex(Graph* graph, char* line) {
-  if (graph == NULL) return false;
+bool updateVertex(ParseChunk* chunk) {
+  Scanner* scanner = &chunk->scanner;
 
   // parse vertex ID
-  char* token = strtok(line, " ");
-  int id = readVertexID(token, graph->numVertices);
+  int id = readVertexID(scanner, chunk->numVertices);
   if (id == -1) return false;
 
   // parse adjacency list
   EdgeList* head = NULL;
   int toVertex = 0;
   int weight = 0;
-  token = strtok(NULL, " ");
-  while (token) {
-    toVertex = readVertexID(token, graph->numVertices);
+  while (!atLineEnd(scanner)) {
+    toVertex = readVertexID(scanner, chunk->numVertices);
     if (toVertex == -1) return false;
 
-    token = strtok(NULL, " ");
-    weight = readWeight(token);
+    weight = readWeight(scanner);
     if (weight == -1) return false;
 
-    head = addEdge(head, id, toVertex, weight);
-    if (head == NULL) return false;
-    graph->numEdges++;
+    if (chunk->nodes == NULL) {
+      if (!appendArc(chunk, toVertex, weight)) return false;
+      continue;
+    }
+    head = addEdge(chunk->nodes, head, id, toVertex, weight);
+    if (head == NULL) return false;  // addEdge has said why
+    chunk->nodes->numEdges++;
+  }
 
-    token = strtok(NULL, " ");
+  if (chunk->numLines == chunk->capacity) {
+    int capacity = chunk->capacity > 0 ? 2 * chunk->capacity : 64;
+    void* bigger;
+    if (chunk->nodes == NULL) {
+      bigger = realloc(chunk->lines, sizeof(int) * 2 * capacity);
+      if (bigger != NULL) chunk->lines = bigger;
+    } else {
+      bigger = realloc(chunk->vertices, sizeof(Vertex*) * capacity);
+      if (bigger != NULL) chunk->vertices = bigger;
+    }
+    if (bigger == NULL) {
+      printf("Could not allocate room for a new Vertex. Giving up.\n");
+      return false;
+    }
+    chunk->capacity = capacity;
+  }
+  if (chunk->nodes == NULL) {
+    chunk->lines[2 * chunk->numLines] = id;
+    chunk->lines[2 * chunk->numLines + 1] = chunk->numArcs;
+    chunk->numLines++;
+    return true;
   }
-  graph->vertices[id] = newVertex(id, NULL, head);  // no values in our file
+  Vertex* vertex = newGraphVertex(chunk->nodes, id, NULL, head);  // no values
+  if (vertex == NULL) {
+    printf("Could not allocate a new Vertex. Giving up.\n");
+    return false;
+  }
+  chunk->vertices[chunk->numLines++] = vertex;
+  return true;
+}
 
+/* Appends the edge to vertex 'toVertex' with weight 'weight' to the arcs of
+ * 'chunk'. Returns true iff there was memory for it.
+ */
+bool appendArc(ParseChunk* chunk, int toVertex, int weight) {
+  if (chunk->numArcs == chunk->arcCapacity) {
+    int capacity = chunk->arcCapacity > 0 ? 2 * chunk->arcCapacity : 1024;
+    int* arcs = realloc(chunk->arcs, sizeof(int) * 2 * capacity);
+    if (arcs == NULL) {
+      printf("Could not allocate a new edge. Giving up.\n");
+      return false;
+    }
+    chunk->arcs = arcs;
+    chunk->arcCapacity = capacity;
+  }
+  chunk->arcs[2 * chunk->numArcs] = toVertex;
+  chunk->arcs[2 * chunk->numArcs + 1] = weight;
+  chunk->numArcs++;
   return true;
 }
 
 /* Prepends a new Edge from vertex 'fromVertex' to vertex 'toVertex' with
- * weight 'weight', to the edge list 'head' and returns the result.
+ * weight 'weight', to the edge list 'head' and returns the result. The new
+ * nodes are allocated from 'graph' and freed together with it.
  */
-EdgeList* addEdge(EdgeList* head, int fromVertex, int toVertex, int weight) {
-  Edge* edge = newEdge(fromVertex, toVertex, weight);
+EdgeList* addEdge(Graph* graph, EdgeList* head, int fromVertex, int toVertex,
+                  int weight) {
+  Edge* edge = newGraphEdge(graph, fromVertex, toVertex, weight);
   if (edge == NULL) {
     printf("Could not allocate a new Edge. Giving up.\n");
     return NULL;
   }
-  EdgeList* edgeList = newEdgeList(edge, head);
+  EdgeList* edgeList = newGraphEdgeList(graph, edge, head);
   if (edgeList == NULL) {
     printf("Could not allocate a new EdgeList. Giving up.\n");
     return NULL;
@@ -196,33 +688,42 @@ EdgeList* addEdge(EdgeList* head, int fromVertex, int toVertex, int weight) {
 }
 
 /* Parses and validates a vertex ID for a graph with 'numVertices' vertices,
- * from 'token'. Returns the ID if validation is successful, and -1 if it is
- * not.
+ * from the current line of 'scanner'. Returns the ID if validation is
+ * successful, and -1 with the reason in scanner->error if it is not.
  */
-int readVertexID(char* token, int numVertices) {
-  if (!token) {
-    printf("Could not read vertex ID from input file. Giving up.\n");
+int readVertexID(Scanner* scanner, int numVertices) {
+  int id;
+  if (!scanInt(scanner, &id)) {
+    if (scanner->error[0] == '\0') {  // else scanInt has said why
+      snprintf(scanner->error, sizeof(scanner->error),
+               "Could not read vertex ID from input file. Giving up.\n");
+    }
     return -1;
   }
-  int id = atoi(token);
   if (id < 0 || id >= numVertices) {
-    printf("Invalid vertex ID: %d. Giving up.\n", id);
+    snprintf(scanner->error, sizeof(scanner->error),
+             "Invalid vertex ID: %d. Giving up.\n", id);
     return -1;
   }
   return id;
 }
 
-/* Parses and validates an edge weight from 'token'. Returns the weight if
- * validation is successful, and -1 if it not.
+/* Parses and validates an edge weight from the current line of 'scanner'.
+ * Returns the weight if validation is successful, and -1 with the reason in
+ * scanner->error if it not.
  */
-int readWeight(char* token) {
-  if (!token) {
-    printf("Could not read edge weight from input file. Giving up.\n");
+int readWeight(Scanner* scanner) {
+  int weight;
+  if (!scanInt(scanner, &weight)) {
+    if (scanner->error[0] == '\0') {  // else scanInt has said why
+      snprintf(scanner->error, sizeof(scanner->error),
+               "Could not read edge weight from input file. Giving up.\n");
+    }
     return -1;
   }
-  int weight = atoi(token);
   if (weight < 0) {
-    printf("Invalid edge weight: %d. Giving up.\n", weight);
+    snprintf(scanner->error, sizeof(scanner->error),
+             "Invalid edge weight: %d. Giving up.\n", weight);
     return -1;
   }
   return weight;
@@ -255,10 +756,829 @@ void printPaths(EdgeList** paths, int numVertices) {
   }
 }
 
-/* Frees memory for all adjacency lists in the array 'paths' of 'numVertices'
- * lists.
+/* Checks the algorithms beyond Prim's and Dijkstra's against them, on
+ * 'graph', loaded from the file 'fileName', and on CHECK_GRAPH, and prints
+ * the outcome of every check.
+ * Returns the number of checks that failed.
  */
-void freePaths(EdgeList** paths, int numVertices) {
-  if (paths == NULL) return;
-  for (int i = 0; i < numVertices; i++) deleteEdgeList(paths[i]);
+int runChecks(Graph* graph, const char* fileName) {
+  int numFailed = 0;
+  if (!reportCheck("MultiQueue", NULL, checkMultiQueue())) numFailed++;
+  if (!reportCheck("chunked parsing", NULL, checkChunkedParsing())) {
+    numFailed++;
+  }
+
+  FILE* f = openCheckInput(NULL);
+  Graph* asymmetric = f != NULL ? createGraph(f) : NULL;
+  if (f != NULL) fclose(f);
+  Graph* graphs[2] = {graph, asymmetric};
+  const char* names[2] = {"the input", "an asymmetric graph"};
+  const char* fileNames[2] = {fileName, NULL};
+  for (int i = 0; i < 2; i++) {
+    if (!reportCheck("loading", names[i], graphs[i] != NULL)) {
+      numFailed++;
+      continue;
+    }
+    CSRGraph* csr = freezeGraph(graphs[i]);
+    if (!reportCheck("compact loading", names[i],
+                     checkCompactLoading(csr, fileNames[i]))) {
+      numFailed++;
+    }
+    if (!reportCheck("contraction hierarchy", names[i],
+                     checkContractionHierarchy(csr))) {
+      numFailed++;
+    }
+    if (!reportCheck("ALT", names[i], checkLandmarks(csr))) numFailed++;
+    if (!reportCheck("delta-stepping", names[i], checkDeltaStepping(csr))) {
+      numFailed++;
+    }
+    if (!reportCheck("graph image", names[i], checkGraphImage(csr))) {
+      numFailed++;
+    }
+    if (!reportCheck("packed graph", names[i], checkPackedGraph(csr))) {
+      numFailed++;
+    }
+    int numComponents = 0;
+    free(getConnectedComponentsCSR(csr, &numComponents));
+    bool connected = numComponents <= 1;
+    if (!connected) {
+      printf("Check Boruvka on %s: skipped, not connected\n", names[i]);
+    } else if (!reportCheck("Boruvka", names[i], checkBoruvka(csr))) {
+      numFailed++;
+    }
+    if (!connected) {
+      printf("Check Kruskal on %s: skipped, not connected\n", names[i]);
+    } else if (!reportCheck("Kruskal", names[i], checkKruskal(csr))) {
+      numFailed++;
+    }
+    if (csr->numVertices > CHECK_MAX_VERTICES) {
+      printf("Check spanning forest on %s: skipped, too many vertices\n",
+             names[i]);
+    } else if (!reportCheck("spanning forest", names[i],
+                            checkSpanningForest(csr))) {
+      numFailed++;
+    }
+    if (csr->numVertices > CHECK_MAX_VERTICES) {
+      printf("Check path queries on %s: skipped, too many vertices\n",
+             names[i]);
+    } else if (!reportCheck("path queries", names[i],
+                            checkPathQuery(graphs[i], csr))) {
+      numFailed++;
+    }
+    if (csr->numVertices > CHECK_MAX_VERTICES) {
+      printf("Check all-pairs distances on %s: skipped, too many vertices\n",
+             names[i]);
+    } else if (!reportCheck("all-pairs distances", names[i],
+                            checkAllPairs(csr))) {
+      numFailed++;
+    }
+    deleteCSRGraph(csr);
+  }
+  if (asymmetric != NULL) deleteGraph(asymmetric);
+  return numFailed;
+}
+
+/* Opens the input file 'fileName' for reading, or CHECK_GRAPH if it is
+ * NULL. Returns NULL if it cannot be opened.
+ */
+FILE* openCheckInput(const char* fileName) {
+  if (fileName != NULL) return fopen(fileName, "r");
+  return fmemopen((void*)CHECK_GRAPH, strlen(CHECK_GRAPH), "r");
+}
+
+/* Returns the number of start vertices the distance checks use on 'csr'. */
+int numCheckSources(CSRGraph* csr) {
+  return csr->numVertices < CHECK_SOURCES ? csr->numVertices : CHECK_SOURCES;
+}
+
+/* Returns the 'i'-th start vertex of the distance checks on 'csr'; they are
+ * spread evenly over the vertex IDs.
+ */
+int checkSource(CSRGraph* csr, int i) {
+  return (int)((long)i * csr->numVertices / numCheckSources(csr));
+}
+
+/* Returns true iff 'path' is a path from vertex 'source' to vertex 'target'
+ * along edges of 'csr', with the weights of those edges, and of total
+ * weight 'distance'; or 'path' is NULL and 'target' is 'source' or cannot
+ * be reached from it (INT_MAX 'distance').
+ */
+bool isShortestPath(CSRGraph* csr, EdgeList* path, int source, int target,
+                    int distance) {
+  if (path == NULL) return source == target || distance == INT_MAX;
+
+  long total = 0;
+  int vertex = source;
+  for (EdgeList* node = path; node != NULL; node = node->next) {
+    Edge* edge = node->edge;
+    if (edge->fromVertex != vertex ||
+        !hasEdge(csr, vertex, edge->toVertex, edge->weight)) {
+      return false;
+    }
+    total += edge->weight;
+    vertex = edge->toVertex;
+  }
+  return vertex == target && total == distance;
+}
+
+/* Returns true iff 'csr' has an edge (fromVertex -- toVertex, weight). */
+bool hasEdge(CSRGraph* csr, int fromVertex, int toVertex, int weight) {
+  for (int e = csr->offsets[fromVertex]; e < csr->offsets[fromVertex + 1];
+       e++) {
+    if (csr->targets[e] == toVertex && csr->weights[e] == weight) return true;
+  }
+  return false;
+}
+
+/* Returns true iff the distance tree 'tree' from vertex 'source' of 'csr',
+ * in the format of getDistanceTreeDijkstra, has the distances of 'expected'
+ * and every reached vertex but 'source' has a predecessor joined to it by
+ * an edge that closes the gap between their distances.
+ */
+bool isDistanceTree(CSRGraph* csr, Edge* tree, Edge* expected, int source) {
+  if (tree == NULL) return false;
+  for (int v = 0; v < csr->numVertices; v++) {
+    int distance = tree[v].weight;
+    if (distance != expected[v].weight) return false;
+    if (v == source || distance == INT_MAX) continue;
+    int predecessor = tree[v].toVertex;
+    if (predecessor < 0 || predecessor >= csr->numVertices ||
+        !hasEdge(csr, predecessor, v, distance - tree[predecessor].weight)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Builds a contraction hierarchy of 'csr' and checks that its distances and
+ * paths, from each check source to every vertex, are the ones Dijkstra's
+ * algorithm finds. Returns true iff they all are.
+ */
+bool checkContractionHierarchy(CSRGraph* csr) {
+  ContractionHierarchy* ch = buildContractionHierarchy(csr);
+  if (ch == NULL) return false;
+
+  bool passed = true;
+  for (int i = 0; i < numCheckSources(csr) && passed; i++) {
+    int source = checkSource(csr, i);
+    Edge* tree = getDistanceTreeDijkstraCSR(csr, source);
+    for (int target = 0; target < csr->numVertices && passed; target++) {
+      int distance = tree[target].weight;
+      EdgeList* path = getShortestPathCH(ch, source, target);
+      passed = getDistanceCH(ch, source, target) == distance &&
+               isShortestPath(csr, path, source, target, distance);
+      deleteEdgeList(path);
+    }
+    free(tree);
+  }
+  deleteContractionHierarchy(ch);
+  return passed;
+}
+
+/* Prints that the check 'name', on the graph 'graphName' unless it is NULL,
+ * passed or failed. Returns 'passed'.
+ */
+bool reportCheck(const char* name, const char* graphName, bool passed) {
+  if (graphName == NULL) {
+    printf("Check %s: %s\n", name, passed ? "ok" : "FAILED");
+  } else {
+    printf("Check %s on %s: %s\n", name, graphName, passed ? "ok" : "FAILED");
+  }
+  return passed;
+}
+
+/* Extracts nodes from the MultiQueue of 'arg', a Drain, until it is empty.
+ */
+void* drainMultiQueue(void* arg) {
+  Drain* drain = arg;
+  HeapNode node;
+  while (multiQueueExtractMin(drain->queue, &node)) {
+    drain->nodes[drain->numNodes++] = node;
+  }
+  return NULL;
+}
+
+/* Fills MultiQueues with CHECK_NODES nodes, lowering (and trying to raise)
+ * the priorities of some, and drains them: once on one thread, checking
+ * that every node comes out once, with its lowest priority, and close to
+ * the minimum; and once on several threads, checking that every node comes
+ * out once. Returns true iff all checks pass.
+ */
+bool checkMultiQueue(void) {
+  int priority[CHECK_NODES];
+  bool seen[CHECK_NODES];
+  unsigned random = 12345;
+  bool passed = true;
+
+  for (int round = 0; round < 2; round++) {
+    MultiQueue* queue = newMultiQueue(CHECK_NODES, CHECK_HEAPS);
+    for (int id = 0; id < CHECK_NODES; id++) {
+      random = random * 1103515245 + 12345;
+      priority[id] = (random >> 8) % 100000;
+      multiQueueInsert(queue, priority[id], id);
+      seen[id] = false;
+    }
+    for (int id = 0; id < CHECK_NODES; id += 3) {
+      multiQueueInsert(queue, priority[id] + 1, id);  // no effect
+      priority[id] /= 2;
+      multiQueueInsert(queue, priority[id], id);
+    }
+    passed = passed && multiQueueSize(queue) == CHECK_NODES;
+
+    // one thread, or four at once
+    int numThreads = round == 0 ? 1 : 4;
+    Drain drains[4];
+    pthread_t threads[4];
+    bool started[4] = {false};
+    for (int i = 0; i < numThreads; i++) {
+      drains[i] = (Drain){queue, malloc(sizeof(HeapNode) * CHECK_NODES), 0};
+      if (i > 0) {
+        started[i] =
+            pthread_create(&threads[i], NULL, drainMultiQueue, &drains[i]) == 0;
+      }
+    }
+    drainMultiQueue(&drains[0]);
+    for (int i = 1; i < numThreads; i++) {
+      if (started[i]) pthread_join(threads[i], NULL);
+    }
+
+    int numNodes = 0;
+    long totalRank = 0;
+    for (int i = 0; i < numThreads; i++) {
+      for (int j = 0; j < drains[i].numNodes; j++) {
+        HeapNode node = drains[i].nodes[j];
+        if (node.id < 0 || node.id >= CHECK_NODES || seen[node.id] ||
+            node.priority != priority[node.id]) {
+          passed = false;
+          continue;
+        }
+        if (numThreads == 1) {
+          // the nodes still in the queue with a lower priority
+          for (int id = 0; id < CHECK_NODES; id++) {
+            if (!seen[id] && priority[id] < node.priority) totalRank++;
+          }
+        }
+        seen[node.id] = true;
+        numNodes++;
+      }
+      free(drains[i].nodes);
+    }
+    // two random choices out of CHECK_HEAPS keep the rank small on average
+    passed = passed && numNodes == CHECK_NODES && multiQueueSize(queue) == 0 &&
+             totalRank <= (long)CHECK_NODES * CHECK_HEAPS;
+    deleteMultiQueue(queue);
+  }
+  return passed;
+}
+
+/* Parses the lines of CHECK_GRAPH, and a last line that replaces the one of
+ * vertex 2, split into 1 to CHECK_CHUNKS chunks, so that the two lines of
+ * vertex 2 end up in different chunks; into a Graph and into a CSRGraph.
+ * Checks that every parse is the same as the CSRGraph in one chunk, which
+ * gives vertex 2 just the edge on its last line. Returns true iff they all
+ * are.
+ */
+bool checkChunkedParsing(void) {
+  const char* text = CHECK_GRAPH "2 6 3\n";
+  Scanner scanner = {text, text + strlen(text), ""};
+  int numVertices;
+  if (!scanInt(&scanner, &numVertices) || !skipBlankLines(&scanner)) {
+    return false;
+  }
+
+  CSRGraph* expected =
+      parseLinesCSR(numVertices, scanner.pos, scanner.end, 1);
+  bool passed = expected != NULL &&
+                expected->offsets[3] - expected->offsets[2] == 1 &&
+                hasEdge(expected, 2, 6, 3);
+  for (int numChunks = 1; numChunks <= CHECK_CHUNKS && passed; numChunks++) {
+    CSRGraph* csr =
+        parseLinesCSR(numVertices, scanner.pos, scanner.end, numChunks);
+    Graph* graph = newArenaGraph(numVertices);
+    bool parsed = graph != NULL &&
+                  parseLines(graph, scanner.pos, scanner.end, numChunks);
+    CSRGraph* frozen = parsed ? freezeGraph(graph) : NULL;
+    passed = csr != NULL && frozen != NULL && isSameCSRGraph(expected, csr) &&
+             isSameCSRGraph(expected, frozen);
+    if (csr != NULL) deleteCSRGraph(csr);
+    if (frozen != NULL) deleteCSRGraph(frozen);
+    if (graph != NULL) deleteGraph(graph);
+  }
+  if (expected != NULL) deleteCSRGraph(expected);
+  return passed;
+}
+
+/* Builds CHECK_LANDMARKS landmarks of 'csr' and checks, from each check
+ * source to every vertex, that their bounds enclose the distance Dijkstra's
+ * algorithm finds and that getShortestPathALT finds a shortest path; and,
+ * towards each check source, that their heuristic is at most the distance
+ * and consistent on every edge into a vertex that reaches it (others are
+ * never on a path there, so their bound does not matter). Returns true iff
+ * all checks pass.
+ */
+bool checkLandmarks(CSRGraph* csr) {
+  Landmarks* landmarks = buildLandmarks(csr, CHECK_LANDMARKS);
+  if (landmarks == NULL) return false;
+  CSRGraph* reverse = reverseCSRGraph(csr);
+
+  bool passed = true;
+  for (int i = 0; i < numCheckSources(csr) && passed; i++) {
+    int source = checkSource(csr, i);
+    Edge* tree = getDistanceTreeDijkstraCSR(csr, source);
+    for (int target = 0; target < csr->numVertices && passed; target++) {
+      int distance = tree[target].weight;
+      EdgeList* path = getShortestPathALT(csr, landmarks, source, target);
+      passed = landmarkLowerBound(landmarks, source, target) <= distance &&
+               landmarkUpperBound(landmarks, source, target) >= distance &&
+               isShortestPath(csr, path, source, target, distance);
+      deleteEdgeList(path);
+    }
+    free(tree);
+
+    // towards 'source': h(u) <= d(u) and h(u) <= w + h(v) for every edge
+    // (u -- v, w) with v reaching 'source'
+    Edge* toSource = getDistanceTreeDijkstraCSR(reverse, source);
+    for (int u = 0; u < csr->numVertices && passed; u++) {
+      long bound = landmarkHeuristic(u, source, landmarks);
+      if (bound > toSource[u].weight) passed = false;
+      for (int e = csr->offsets[u]; e < csr->offsets[u + 1]; e++) {
+        int v = csr->targets[e];
+        long next = landmarkHeuristic(v, source, landmarks);
+        if (toSource[v].weight != INT_MAX && bound > csr->weights[e] + next) {
+          passed = false;
+        }
+      }
+    }
+    free(toSource);
+  }
+  deleteCSRGraph(reverse);
+  deleteLandmarks(landmarks);
+  return passed;
+}
+
+/* Answers the queries from each check source to every vertex of 'csr',
+ * which is freezeGraph('graph'), with one PathQuery on 'graph' and one on
+ * 'csr' with four times as many edgeless vertices added, so that no search
+ * touches enough vertices for resetRecords to clear them all; each by
+ * Dijkstra's algorithm, bidirectionally, and by A* guided by landmarks.
+ * Checks those paths, and the paths getShortestPathDijkstra and
+ * getShortestPathDijkstraCSR find, against the distances Dijkstra's
+ * algorithm finds. Returns true iff they are all shortest paths.
+ */
+bool checkPathQuery(Graph* graph, CSRGraph* csr) {
+  CSRGraph* padded = padCSRGraph(csr, 4 * csr->numVertices);
+  Landmarks* landmarks = buildLandmarks(csr, CHECK_LANDMARKS);
+  PathQuery* queries[2] = {newPathQuery(graph), newPathQueryCSR(padded)};
+  bool passed = landmarks != NULL && queries[0] != NULL && queries[1] != NULL;
+
+  for (int i = 0; i < numCheckSources(csr) && passed; i++) {
+    int source = checkSource(csr, i);
+    Edge* tree = getDistanceTreeDijkstraCSR(csr, source);
+    for (int target = 0; target < csr->numVertices && passed; target++) {
+      EdgeList* paths[8];
+      for (int j = 0; j < 2; j++) {
+        PathQuery* query = queries[j];
+        paths[3 * j] = queryPathDijkstra(query, source, target);
+        paths[3 * j + 1] = queryPathBidirectional(query, source, target);
+        paths[3 * j + 2] = queryPathAStar(query, source, target,
+                                          landmarkHeuristic, landmarks);
+      }
+      paths[6] = getShortestPathDijkstra(graph, source, target);
+      paths[7] = getShortestPathDijkstraCSR(csr, source, target);
+      for (int j = 0; j < 8; j++) {
+        passed = passed && isShortestPath(csr, paths[j], source, target,
+                                          tree[target].weight);
+        deleteEdgeList(paths[j]);
+      }
+    }
+    free(tree);
+  }
+  for (int j = 0; j < 2; j++) {
+    if (queries[j] != NULL) deletePathQuery(queries[j]);
+  }
+  if (landmarks != NULL) deleteLandmarks(landmarks);
+  deleteCSRGraph(padded);
+  return passed;
+}
+
+/* Checks getAllPairsDistancesCSR on 'csr', in memory, and on 'csr' with
+ * enough isolated vertices added that it is too sparse for Floyd-Warshall,
+ * in a file on two threads, so that both ways of filling the matrix are
+ * checked. Returns true iff both matrices are right.
+ */
+bool checkAllPairs(CSRGraph* csr) {
+  int numExtra = 0;
+  while ((long)(csr->numVertices + numExtra) * (csr->numVertices + numExtra) <
+         64L * csr->numEdges) {
+    numExtra += csr->numVertices + 1;
+  }
+  CSRGraph* sparse = padCSRGraph(csr, numExtra);
+  bool passed = checkDistanceMatrix(csr, 0, false) &&
+                checkDistanceMatrix(sparse, 2, true);
+  deleteCSRGraph(sparse);
+  return passed;
+}
+
+/* Computes the distances between all pairs of vertices of 'csr' with
+ * getAllPairsDistancesCSR on 'numThreads' threads, in a temporary file if
+ * 'inFile' is true, and returns true iff every row equals the distances
+ * Dijkstra's algorithm finds.
+ */
+bool checkDistanceMatrix(CSRGraph* csr, int numThreads, bool inFile) {
+  char fileName[] = "/tmp/tester-matrix-XXXXXX";
+  if (inFile) {
+    int fd = mkstemp(fileName);
+    if (fd == -1) return false;
+    close(fd);
+  }
+  DistanceMatrix* matrix =
+      getAllPairsDistancesCSR(csr, numThreads, inFile ? fileName : NULL);
+  if (inFile) remove(fileName);  // the mapping stays valid
+  if (matrix == NULL) return false;
+
+  bool passed = matrix->numVertices == csr->numVertices;
+  for (int from = 0; from < csr->numVertices && passed; from++) {
+    Edge* tree = getDistanceTreeDijkstraCSR(csr, from);
+    for (int to = 0; to < csr->numVertices; to++) {
+      if (getMatrixDistance(matrix, from, to) != tree[to].weight) {
+        passed = false;
+      }
+    }
+    free(tree);
+  }
+  deleteDistanceMatrix(matrix);
+  return passed;
+}
+
+/* Returns a copy of 'csr' with 'numExtra' more vertices, which have no
+ * edges.
+ */
+CSRGraph* padCSRGraph(CSRGraph* csr, int numExtra) {
+  int numVertices = csr->numVertices + numExtra;
+  CSRGraph* padded = newCSRGraph(numVertices, csr->numEdges);
+  for (int v = 0; v <= numVertices; v++) {
+    padded->offsets[v] = csr->offsets[v < csr->numVertices ? v
+                                                           : csr->numVertices];
+  }
+  for (int e = 0; e < csr->numEdges; e++) {
+    padded->targets[e] = csr->targets[e];
+    padded->weights[e] = csr->weights[e];
+  }
+  finishCSRGraph(padded);
+  return padded;
+}
+
+/* Runs delta-stepping on 'csr' from each check source with buckets of the
+ * default width, of width 1, and wide enough for every edge to be light, on
+ * one thread and on four, and checks every tree against Dijkstra's
+ * algorithm. Returns true iff all trees are right.
+ */
+bool checkDeltaStepping(CSRGraph* csr) {
+  int widest = csr->maxWeight < INT_MAX ? csr->maxWeight + 1 : INT_MAX;
+  int deltas[3] = {0, 1, widest};
+  bool passed = true;
+  for (int i = 0; i < numCheckSources(csr) && passed; i++) {
+    int source = checkSource(csr, i);
+    Edge* expected = getDistanceTreeDijkstraCSR(csr, source);
+    for (int j = 0; j < 6 && passed; j++) {
+      Edge* tree = getDistanceTreeDeltaStepping(csr, source, deltas[j / 2],
+                                                j % 2 == 0 ? 1 : 4);
+      passed = isDistanceTree(csr, tree, expected, source);
+      free(tree);
+    }
+    free(expected);
+  }
+  return passed;
+}
+
+/* Runs Boruvka's algorithm on one thread and on four on 'csr' with a
+ * reverse added for every edge, as it requires, and checks that each time
+ * it returns a spanning tree as light as the one Prim's algorithm finds.
+ * Returns true iff it does.
+ * Precondition: 'csr' is connected, its edges taken as undirected
+ */
+bool checkBoruvka(CSRGraph* csr) {
+  CSRGraph* symmetric = symmetrizeCSRGraph(csr);
+  Edge* prim = getMSTprimCSR(symmetric, 0);
+  long expected = spanningTreeWeight(symmetric, prim);
+  free(prim);
+
+  bool passed = expected != -1;
+  for (int numThreads = 1; numThreads <= 4 && passed; numThreads += 3) {
+    Edge* tree = getMSTboruvkaCSR(symmetric, numThreads);
+    passed = spanningTreeWeight(symmetric, tree) == expected;
+    free(tree);
+  }
+  deleteCSRGraph(symmetric);
+  return passed;
+}
+
+/* Runs Kruskal's algorithm on 'csr' and checks that it returns a spanning
+ * tree, of 'csr' with a reverse added for every edge, as light as the one
+ * Prim's algorithm finds on that. Returns true iff it does.
+ * Precondition: 'csr' is connected, its edges taken as undirected
+ */
+bool checkKruskal(CSRGraph* csr) {
+  CSRGraph* symmetric = symmetrizeCSRGraph(csr);
+  Edge* prim = getMSTprimCSR(symmetric, 0);
+  long expected = spanningTreeWeight(symmetric, prim);
+  free(prim);
+
+  Edge* tree = getMSTkruskalCSR(csr);
+  bool passed =
+      expected != -1 && spanningTreeWeight(symmetric, tree) == expected;
+  free(tree);
+  deleteCSRGraph(symmetric);
+  return passed;
+}
+
+/* Adds CHECK_EXTRA_VERTICES edgeless vertices to 'csr', so that it is not
+ * connected, and checks that getConnectedComponentsCSR labels, and
+ * getMinimumSpanningForestCSR spans, a component per vertex Prim's
+ * algorithm does not reach from a smaller one: with the vertices Prim's
+ * spans from it, and a tree of its edges as light as Prim's. Returns true
+ * iff all checks pass.
+ */
+bool checkSpanningForest(CSRGraph* csr) {
+  CSRGraph* padded = padCSRGraph(csr, CHECK_EXTRA_VERTICES);
+  CSRGraph* symmetric = symmetrizeCSRGraph(padded);
+  int numVertices = padded->numVertices;
+  int numComponents = 0;
+  int* component = getConnectedComponentsCSR(padded, &numComponents);
+  SpanningForest* forest = getMinimumSpanningForestCSR(padded);
+  bool passed = component != NULL && forest != NULL &&
+                forest->numComponents == numComponents;
+
+  // Prim's from the smallest vertex of every component spans just it
+  int* expected = malloc(sizeof(int) * numVertices);
+  for (int v = 0; v < numVertices; v++) expected[v] = -1;
+  int numExpected = 0;
+  long expectedWeight = 0;
+  for (int v = 0; v < numVertices && passed; v++) {
+    if (expected[v] != -1) continue;
+    expected[v] = numExpected;
+    Edge* prim = getMSTprimCSR(symmetric, v);
+    for (int i = 0; i < numVertices - 1; i++) {
+      if (prim[i].fromVertex == -1) continue;
+      expected[prim[i].fromVertex] = numExpected;
+      expected[prim[i].toVertex] = numExpected;
+    }
+    expectedWeight += forestWeight(prim, numVertices - 1);
+    free(prim);
+    numExpected++;
+  }
+  for (int v = 0; v < numVertices && passed; v++) {
+    passed = component[v] == expected[v] && forest->component[v] == expected[v];
+  }
+  free(expected);
+
+  // every tree has the edges of its own component only
+  passed = passed && numComponents == numExpected &&
+           forest->treeStarts[numComponents] == numVertices - numComponents;
+  for (int c = 0; c < numComponents && passed; c++) {
+    for (int i = forest->treeStarts[c]; i < forest->treeStarts[c + 1]; i++) {
+      Edge edge = forest->edges[i];
+      if (component[edge.fromVertex] != c || component[edge.toVertex] != c ||
+          !hasEdge(symmetric, edge.fromVertex, edge.toVertex, edge.weight)) {
+        passed = false;
+      }
+    }
+  }
+  passed = passed && forestWeight(forest->edges, numVertices - numComponents) ==
+                         expectedWeight;
+
+  free(component);
+  deleteSpanningForest(forest);
+  deleteCSRGraph(symmetric);
+  deleteCSRGraph(padded);
+  return passed;
+}
+
+/* Returns a copy of 'csr' in which every edge (u -- v, w) also has a
+ * reverse (v -- u, w).
+ */
+CSRGraph* symmetrizeCSRGraph(CSRGraph* csr) {
+  int numVertices = csr->numVertices;
+  CSRGraph* symmetric = newCSRGraph(numVertices, 2 * csr->numEdges);
+  // count the edges of every vertex, then place them after those before it
+  for (int u = 0; u < numVertices; u++) {
+    for (int e = csr->offsets[u]; e < csr->offsets[u + 1]; e++) {
+      symmetric->offsets[u + 1]++;
+      symmetric->offsets[csr->targets[e] + 1]++;
+    }
+  }
+  for (int u = 0; u < numVertices; u++) {
+    symmetric->offsets[u + 1] += symmetric->offsets[u];
+  }
+  int* next = malloc(sizeof(int) * (numVertices + 1));
+  memcpy(next, symmetric->offsets, sizeof(int) * (numVertices + 1));
+  for (int u = 0; u < numVertices; u++) {
+    for (int e = csr->offsets[u]; e < csr->offsets[u + 1]; e++) {
+      int v = csr->targets[e];
+      symmetric->targets[next[u]] = v;
+      symmetric->weights[next[u]++] = csr->weights[e];
+      symmetric->targets[next[v]] = u;
+      symmetric->weights[next[v]++] = csr->weights[e];
+    }
+  }
+  free(next);
+  finishCSRGraph(symmetric);
+  return symmetric;
+}
+
+/* Returns the total weight of 'tree', an array of numVertices-1 Edges, if
+ * they are edges of 'csr' that join all its vertices, and -1 if they are
+ * not.
+ */
+long spanningTreeWeight(CSRGraph* csr, Edge* tree) {
+  if (tree == NULL) return -1;
+  int numVertices = csr->numVertices;
+  // union-find: the edges join all vertices iff none closes a cycle
+  int* parent = malloc(sizeof(int) * numVertices);
+  for (int v = 0; v < numVertices; v++) parent[v] = v;
+
+  long total = 0;
+  for (int i = 0; i < numVertices - 1 && total != -1; i++) {
+    int u = tree[i].fromVertex;
+    int v = tree[i].toVertex;
+    if (u < 0 || u >= numVertices || v < 0 || v >= numVertices ||
+        !hasEdge(csr, u, v, tree[i].weight)) {
+      total = -1;
+      break;
+    }
+    while (parent[u] != u) u = parent[u] = parent[parent[u]];
+    while (parent[v] != v) v = parent[v] = parent[parent[v]];
+    if (u == v) {
+      total = -1;
+      break;
+    }
+    parent[u] = v;
+    total += tree[i].weight;
+  }
+  free(parent);
+  return total;
+}
+
+/* Returns the total weight of the edges in 'tree', an array of 'numEdges'
+ * Edges from Prim's algorithm, skipping the entries (-1 -- -1, -1) left for
+ * vertices the tree does not span.
+ */
+long forestWeight(Edge* tree, int numEdges) {
+  if (tree == NULL) return -1;
+  long total = 0;
+  for (int i = 0; i < numEdges; i++) {
+    if (tree[i].fromVertex != -1) total += tree[i].weight;
+  }
+  return total;
+}
+
+/* Saves 'csr' as a graph image in a temporary file and checks that it
+ * loads, with and without verification, as the same graph, with the same
+ * distances from every check source; and that once one byte of the image
+ * is changed, verification rejects it. Returns true iff all checks pass.
+ */
+bool checkGraphImage(CSRGraph* csr) {
+  char fileName[] = "/tmp/tester-image-XXXXXX";
+  int fd = mkstemp(fileName);
+  if (fd == -1) return false;
+  close(fd);
+
+  bool passed = saveGraphBinary(csr, fileName);
+  for (int verify = 0; verify < 2 && passed; verify++) {
+    CSRGraph* loaded = loadGraphBinary(fileName, verify);
+    passed = loaded != NULL && isSameCSRGraph(csr, loaded);
+    for (int i = 0; i < numCheckSources(csr) && passed; i++) {
+      int source = checkSource(csr, i);
+      Edge* expected = getDistanceTreeDijkstraCSR(csr, source);
+      Edge* tree = getDistanceTreeDijkstraCSR(loaded, source);
+      passed = isDistanceTree(csr, tree, expected, source);
+      free(tree);
+      free(expected);
+    }
+    if (loaded != NULL) deleteCSRGraph(loaded);
+  }
+
+  // flip the bits of the last byte, the last weight if there are edges
+  FILE* f = passed ? fopen(fileName, "r+b") : NULL;
+  if (f != NULL && fseek(f, -1, SEEK_END) == 0) {
+    int byte = fgetc(f);
+    fseek(f, -1, SEEK_END);
+    fputc(byte ^ 0xff, f);
+    fclose(f);
+    CSRGraph* corrupted = loadGraphBinary(fileName, true);
+    passed = corrupted == NULL;
+    if (corrupted != NULL) deleteCSRGraph(corrupted);
+  } else {
+    if (f != NULL) fclose(f);
+    passed = false;
+  }
+  remove(fileName);
+  return passed;
+}
+
+/* Returns true iff 'csr' and 'other' have the same vertices and edges, in
+ * the same order, and the same maximum weight.
+ */
+bool isSameCSRGraph(CSRGraph* csr, CSRGraph* other) {
+  if (csr->numVertices != other->numVertices ||
+      csr->numEdges != other->numEdges ||
+      csr->maxWeight != other->maxWeight) {
+    return false;
+  }
+  size_t offsetBytes = sizeof(int) * (csr->numVertices + 1);
+  size_t edgeBytes = sizeof(int) * csr->numEdges;
+  if (memcmp(csr->offsets, other->offsets, offsetBytes) != 0) return false;
+  return csr->numEdges == 0 ||
+         (memcmp(csr->targets, other->targets, edgeBytes) == 0 &&
+          memcmp(csr->weights, other->weights, edgeBytes) == 0);
+}
+
+/* Loads the input file 'fileName', or CHECK_GRAPH if it is NULL, with
+ * createCSRGraph, and checks that the result is the same as 'csr', which
+ * is freezeGraph of createGraph on it. Returns true iff it is.
+ */
+bool checkCompactLoading(CSRGraph* csr, const char* fileName) {
+  FILE* f = openCheckInput(fileName);
+  if (f == NULL) return false;
+  CSRGraph* compact = createCSRGraph(f);
+  fclose(f);
+
+  bool passed = compact != NULL && isSameCSRGraph(csr, compact);
+  if (compact != NULL) deleteCSRGraph(compact);
+  return passed;
+}
+
+/* Packs 'csr' and checks that it unpacks to the same edges, sorted; that
+ * Dijkstra's algorithm on the packed graph finds the distances it finds on
+ * 'csr' from every check source; and that Prim's algorithm on the packed
+ * graph of 'csr' with a reverse added for every edge finds a tree as light
+ * as on the unpacked one. Returns true iff all checks pass.
+ */
+bool checkPackedGraph(CSRGraph* csr) {
+  PackedGraph* packed = packGraph(csr);
+  if (packed == NULL) return false;
+  CSRGraph* unpacked = unpackGraph(packed);
+  bool passed = unpacked != NULL && hasSameEdges(csr, unpacked);
+  if (unpacked != NULL) deleteCSRGraph(unpacked);
+
+  CSRGraph* symmetric = symmetrizeCSRGraph(csr);
+  PackedGraph* packedSymmetric = packGraph(symmetric);
+  passed = passed && packedSymmetric != NULL;
+  for (int i = 0; i < numCheckSources(csr) && passed; i++) {
+    int source = checkSource(csr, i);
+    Edge* expected = getDistanceTreeDijkstraCSR(csr, source);
+    Edge* tree = getDistanceTreeDijkstraPacked(packed, source);
+    passed = isDistanceTree(csr, tree, expected, source);
+    free(tree);
+    free(expected);
+
+    int numTreeEdges = csr->numVertices - 1;
+    Edge* prim = getMSTprimCSR(symmetric, source);
+    Edge* primPacked = getMSTprimPacked(packedSymmetric, source);
+    passed = passed && primPacked != NULL &&
+             forestWeight(primPacked, numTreeEdges) ==
+                 forestWeight(prim, numTreeEdges);
+    free(prim);
+    free(primPacked);
+  }
+  if (packedSymmetric != NULL) deletePackedGraph(packedSymmetric);
+  deleteCSRGraph(symmetric);
+  deletePackedGraph(packed);
+  return passed;
+}
+
+/* Returns true iff 'sorted' has the vertices of 'csr' and, for every
+ * vertex, the edges it has in 'csr', sorted by "to" vertex and weight.
+ */
+bool hasSameEdges(CSRGraph* csr, CSRGraph* sorted) {
+  if (csr->numVertices != sorted->numVertices ||
+      csr->numEdges != sorted->numEdges ||
+      csr->maxWeight != sorted->maxWeight) {
+    return false;
+  }
+  Edge* edges = malloc(sizeof(Edge) * (csr->numEdges > 0 ? csr->numEdges : 1));
+  bool same = true;
+  for (int v = 0; v < csr->numVertices && same; v++) {
+    int degree = csr->offsets[v + 1] - csr->offsets[v];
+    same = sorted->offsets[v + 1] - sorted->offsets[v] == degree;
+    for (int i = 0; i < degree && same; i++) {
+      edges[i] = getCSREdge(csr, v, i);
+    }
+    if (same) qsort(edges, degree, sizeof(Edge), compareEdges);
+    for (int i = 0; i < degree && same; i++) {
+      Edge edge = getCSREdge(sorted, v, i);
+      same = compareEdges(&edge, &edges[i]) == 0;
+    }
+  }
+  free(edges);
+  return same;
+}
+
+/* Compares Edges 'a' and 'b' by "to" vertex, then by weight, for qsort.
+ */
+int compareEdges(const void* a, const void* b) {
+  const Edge* x = a;
+  const Edge* y = b;
+  if (x->toVertex != y->toVertex) return x->toVertex < y->toVertex ? -1 : 1;
+  return (x->weight > y->weight) - (x->weight < y->weight);
 }
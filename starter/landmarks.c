@@ -0,0 +1,152 @@
+/*
+ * Our landmark (ALT) distance bounds.
+ */
+
+#include <limits.h>
+
+#include "graph_algos.h"
+#include "landmarks.h"
+
+#define UNREACHED INT_MAX  // distance of a vertex not reachable from another
+
+/*************************************************************************
+ ** Helper functions
+ *************************************************************************/
+
+/* Copies the distances in the Dijkstra tree 'distTree' into column 'column'
+ * of the vertex-major table 'table' with 'numColumns' columns.
+ */
+void storeDistances(Edge* distTree, int numVertices, int* table, int column,
+                    int numColumns){
+  for (int v = 0; v < numVertices; v++){
+    table[v*numColumns + column] = distTree[v].weight;
+  }
+}
+
+/*********************************************************************
+ * Required functions
+ ********************************************************************/
+/* Picks up to 'numLandmarks' landmarks in 'graph' by farthest-point
+ * selection: each new landmark is the vertex farthest from all landmarks
+ * picked so far, preferring vertices they cannot reach at all. Runs
+ * Dijkstra's algorithm from and to every landmark and returns the
+ * resulting distance tables.
+ * Returns NULL if 'graph' is NULL or numLandmarks < 1.
+ */
+Landmarks* buildLandmarks(CSRGraph* graph, int numLandmarks){
+  if (graph == NULL || numLandmarks < 1) return NULL;
+  int n = graph->numVertices;
+  if (numLandmarks > n) numLandmarks = n;
+
+  Landmarks* landmarks = malloc(sizeof(Landmarks));
+  landmarks->numVertices = n;
+  landmarks->numLandmarks = numLandmarks;
+  landmarks->landmarks = malloc(sizeof(int)*numLandmarks);
+  landmarks->fromLandmark = malloc(sizeof(int)*n*numLandmarks);
+  landmarks->toLandmark = malloc(sizeof(int)*n*numLandmarks);
+  if (n == 0) return landmarks;
+
+  CSRGraph* reverse = reverseCSRGraph(graph);
+  // closest[v] is the distance to v from the nearest landmark so far; the
+  // first landmark is the vertex farthest from vertex 0
+  int* closest = malloc(sizeof(int)*n);
+  Edge* seedTree = getDistanceTreeDijkstraCSR(graph, 0);
+  for (int v = 0; v < n; v++){
+    closest[v] = seedTree[v].weight;
+  }
+  free(seedTree);
+
+  for (int i = 0; i < numLandmarks; i++){
+    int farthest = 0;
+    for (int v = 1; v < n; v++){
+      if (closest[v] > closest[farthest]){
+        farthest = v;
+      }
+    }
+    landmarks->landmarks[i] = farthest;
+
+    Edge* fromTree = getDistanceTreeDijkstraCSR(graph, farthest);
+    storeDistances(fromTree, n, landmarks->fromLandmark, i, numLandmarks);
+    Edge* toTree = getDistanceTreeDijkstraCSR(reverse, farthest);
+    storeDistances(toTree, n, landmarks->toLandmark, i, numLandmarks);
+    for (int v = 0; v < n; v++){
+      if (i == 0 || fromTree[v].weight < closest[v]){
+        closest[v] = fromTree[v].weight;
+      }
+    }
+    free(fromTree);
+    free(toTree);
+  }
+
+  free(closest);
+  deleteCSRGraph(reverse);
+  return landmarks;
+}
+
+/* Returns a lower bound on the distance from vertex 'vertex' to vertex
+ * 'target', from the triangle inequality on the landmarks in 'landmarks'.
+ */
+int landmarkLowerBound(Landmarks* landmarks, int vertex, int target){
+  int k = landmarks->numLandmarks;
+  int* fromV = &landmarks->fromLandmark[vertex*k];
+  int* fromT = &landmarks->fromLandmark[target*k];
+  int* toV = &landmarks->toLandmark[vertex*k];
+  int* toT = &landmarks->toLandmark[target*k];
+  int bound = 0;
+  for (int i = 0; i < k; i++){
+    // a bound that involves an unreachable landmark says nothing
+    if (fromT[i] != UNREACHED && fromV[i] != UNREACHED &&
+        fromT[i] - fromV[i] > bound){
+      bound = fromT[i] - fromV[i];  // d(L, t) - d(L, v)
+    }
+    if (toV[i] != UNREACHED && toT[i] != UNREACHED &&
+        toV[i] - toT[i] > bound){
+      bound = toV[i] - toT[i];      // d(v, L) - d(t, L)
+    }
+  }
+  return bound;
+}
+
+/* Returns an upper bound on the distance from vertex 'source' to vertex
+ * 'target': the length of the shortest path through a landmark in
+ * 'landmarks'. Returns INT_MAX if no landmark lies on a path between them.
+ */
+int landmarkUpperBound(Landmarks* landmarks, int source, int target){
+  int k = landmarks->numLandmarks;
+  int* toS = &landmarks->toLandmark[source*k];
+  int* fromT = &landmarks->fromLandmark[target*k];
+  int bound = UNREACHED;
+  for (int i = 0; i < k; i++){
+    if (toS[i] != UNREACHED && fromT[i] != UNREACHED &&
+        toS[i] + fromT[i] < bound){
+      bound = toS[i] + fromT[i];    // d(s, L) + d(L, t)
+    }
+  }
+  return bound;
+}
+
+/* A DistanceHeuristic (see graph_algos.h) whose 'context' is a Landmarks:
+ * returns landmarkLowerBound('context', 'vertex', 'target').
+ */
+int landmarkHeuristic(int vertex, int target, void* context){
+  return landmarkLowerBound(context, vertex, target);
+}
+
+/* Same as getShortestPathDijkstraCSR, but runs an A* search guided by the
+ * lower bounds in 'landmarks', built for 'graph'.
+ */
+EdgeList* getShortestPathALT(CSRGraph* graph, Landmarks* landmarks,
+                             int source, int target){
+  return getShortestPathAStarCSR(graph, source, target, landmarkHeuristic,
+                                 landmarks);
+}
+
+/* Frees all memory allocated for 'landmarks'.
+ */
+void deleteLandmarks(Landmarks* landmarks){
+  if (landmarks == NULL) return;
+  free(landmarks->landmarks);
+  free(landmarks->fromLandmark);
+  free(landmarks->toLandmark);
+  free(landmarks);
+}
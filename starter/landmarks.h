@@ -0,0 +1,66 @@
+/*
+ * Header file for our landmark (ALT) distance bounds.
+ *
+ * A few "landmark" vertices are picked, and the distances from and to every
+ * landmark are stored for every vertex. By the triangle inequality, for any
+ * landmark L, d(v, t) >= d(L, t) - d(L, v) and d(v, t) >= d(v, L) - d(t, L),
+ * which gives A* search a lower bound on the remaining distance without
+ * any coordinates. d(s, L) + d(L, t) is an upper bound, available in O(k)
+ * time for k landmarks without any search.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __Landmarks_header
+#define __Landmarks_header
+
+typedef struct landmarks {
+  int numVertices;    // total number of vertices in the graph
+  int numLandmarks;   // number of landmarks, k
+  int* landmarks;     // the k landmark IDs
+  int* fromLandmark;  // fromLandmark[id*k + i] is the distance from landmark
+                      //   i to vertex id, or INT_MAX if there is no path
+  int* toLandmark;    // toLandmark[id*k + i] is the distance from vertex id
+                      //   to landmark i, or INT_MAX if there is no path
+} Landmarks;
+
+/* Picks up to 'numLandmarks' landmarks in 'graph' by farthest-point
+ * selection: each new landmark is the vertex farthest from all landmarks
+ * picked so far, preferring vertices they cannot reach at all. Runs
+ * Dijkstra's algorithm from and to every landmark and returns the
+ * resulting distance tables.
+ * Returns NULL if 'graph' is NULL or numLandmarks < 1.
+ */
+Landmarks* buildLandmarks(CSRGraph* graph, int numLandmarks);
+
+/* Returns a lower bound on the distance from vertex 'vertex' to vertex
+ * 'target', from the triangle inequality on the landmarks in 'landmarks'.
+ */
+int landmarkLowerBound(Landmarks* landmarks, int vertex, int target);
+
+/* Returns an upper bound on the distance from vertex 'source' to vertex
+ * 'target': the length of the shortest path through a landmark in
+ * 'landmarks'. Returns INT_MAX if no landmark lies on a path between them.
+ */
+int landmarkUpperBound(Landmarks* landmarks, int source, int target);
+
+/* A DistanceHeuristic (see graph_algos.h) whose 'context' is a Landmarks:
+ * returns landmarkLowerBound('context', 'vertex', 'target').
+ */
+int landmarkHeuristic(int vertex, int target, void* context);
+
+/* Same as getShortestPathDijkstraCSR, but runs an A* search guided by the
+ * lower bounds in 'landmarks', built for 'graph'.
+ */
+EdgeList* getShortestPathALT(CSRGraph* graph, Landmarks* landmarks,
+                             int source, int target);
+
+/* Frees all memory allocated for 'landmarks'.
+ */
+void deleteLandmarks(Landmarks* landmarks);
+
+#endif
@@ -8,55 +8,49 @@
 
 #define ROOT_INDEX 1
 #define NOTHING -1
+#define CACHE_LINE 64  // bytes
+// arr is shifted so that arr[ROOT_INDEX+1], the first child of the root,
+// starts a cache line; every later group of 4 or 8 siblings then sits in a
+// single line
+#define ARR_PAD (CACHE_LINE / sizeof(HeapNode) - (ROOT_INDEX + 1))
+
+void bubbleDownFrom(MinHeap* heap, int nodeIndex);
+int firstChildIdx(MinHeap* heap, int nodeIndex);
+int parentIdx(MinHeap* heap, int nodeIndex);
+bool isValidIndex(MinHeap* heap, int maybeIdx);
+HeapNode nodeAt(MinHeap* heap, int nodeIndex);
+int priorityAt(MinHeap* heap, int nodeIndex);
+int idAt(MinHeap* heap, int nodeIndex);
+int indexOf(MinHeap* heap, int id);
 
 /*************************************************************************
  ** Suggested helper functions -- part of starter code
  *************************************************************************/
 
-/* Swaps contents of heap->arr[index1] and heap->arr[index2] if both 'index1'
- * and 'index2' are valid indices for minheap 'heap'. Has no effect
- * otherwise.
+/* Stores 'node' at index 'nodeIndex' of minheap 'heap' and records the new
+ * position in the index map.
  */
-void swap(MinHeap* heap, int index1, int index2){
-       if (isValidIndex(heap,index1) && isValidIndex(heap,index2)){
-              
-              int priorityIndex1 = priorityAt(heap,index1);
-              int idIndex1 = idAt(heap,index1);
-              int priorityIndex2 = priorityAt(heap,index2);
-              int idIndex2 = idAt(heap,index2);
-
-              heap->arr[index1].priority = priorityIndex2;
-              heap->arr[index1].id = idIndex2;
-
-              heap->arr[index2].priority = priorityIndex1;
-              heap->arr[index2].id = idIndex1;
-
-              heap->indexMap[idIndex1] = index2;
-              heap->indexMap[idIndex2] = index1;
-       }
+void placeNode(MinHeap* heap, int nodeIndex, HeapNode node){
+       heap->arr[nodeIndex] = node;
+       heap->indexMap[node.id] = nodeIndex;
 }
 
 /* Bubbles up the element newly inserted into minheap 'heap' at index
  * 'nodeIndex', if 'nodeIndex' is a valid index for heap. Has no effect
  * otherwise.
+ * Note: the element is kept aside while its ancestors move down into the
+ * hole it leaves, and is written back once, at its final position.
  */
 void bubbleUp(MinHeap* heap, int nodeIndex){
        if (isValidIndex(heap,nodeIndex)){
-              int nodeId = idAt(heap,nodeIndex);    // stay constant
-              int nodePriority = priorityAt(heap,nodeIndex); // stay constant
-              int parentIndex = parentIdx(heap,nodeIndex); // need to update
-              int parentPriority = priorityAt(heap,parentIndex); // need to update
-              //printf("nodeIndex is %d ,", nodeIndex);
-              //printf("parentIndex is %d, parentP is %d and nodeP is %d\n", parentIndex,parentPriority,nodePriority);
-              while(parentIndex != NOTHING && parentPriority > nodePriority){
-                     //printf("ready to bubble up\n");
-                     swap(heap,parentIndex,nodeIndex);
-                     //printf("One swap of Bubble up is done\n");
+              HeapNode node = nodeAt(heap,nodeIndex);
+              int parentIndex = parentIdx(heap,nodeIndex);
+              while(parentIndex != NOTHING && priorityAt(heap,parentIndex) > node.priority){
+                     placeNode(heap,nodeIndex,nodeAt(heap,parentIndex));
                      nodeIndex = parentIndex;
                      parentIndex =  parentIdx(heap,nodeIndex);
-                     parentPriority = priorityAt(heap,parentIndex);
               }
-
+              placeNode(heap,nodeIndex,node);
        }
 }
 
@@ -64,84 +58,51 @@ void bubbleUp(MinHeap* heap, int nodeIndex){
  * if it exists. Has no effect otherwise.
  */
 void bubbleDown(MinHeap* heap){
-       int root = ROOT_INDEX;
-       
-       int rootId = idAt(heap,root);
-       int rootPriority = priorityAt(heap,root);
-
-       int leftIndex = leftIdx(heap,root);
-
-       int rightIndex = rightIdx(heap,root);
-
-       while (leftIndex != NOTHING){
-              int leftId = idAt(heap,leftIndex);
-              int leftPriority = priorityAt(heap,leftIndex);
-
-              if (rightIndex != NOTHING){
-                     int rightId = idAt(heap,rightIndex);
-                     int rightPriority = priorityAt(heap,rightIndex);
-
-                     if (rootPriority>leftPriority && rootPriority>rightPriority){
-                            if(leftPriority>rightPriority){
-                                   swap(heap,root,rightIndex);
-                            }
-                            else if(leftPriority<rightPriority){
-                                   swap(heap,root,leftIndex);
-                            }
-                     }
-
-                     else if (rootPriority>leftPriority && rootPriority<rightPriority){
-                            swap(heap,root,leftIndex);
-                     }
-
-
-                     else if (rootPriority<leftPriority && rootPriority>rightPriority){
-                            swap(heap,root,rightIndex);
-                     }
-
-                     else{
-                            break;
-                     }
-
-              }
-
-              else if (rightIndex == NOTHING){
-                     if(rootPriority > leftPriority){
-                            swap(heap,root,leftIndex);
-                     }
-                     else{
-                            break;
-                     }
-              }
-
-              root = indexOf(heap,rootId);
-              leftIndex = leftIdx(heap,root);
-              rightIndex = rightIdx(heap,root);
-              
-       }
+       bubbleDownFrom(heap,ROOT_INDEX);
 }
 
-/* Returns the index of the left child of a node at index 'nodeIndex' in
- * minheap 'heap', if such exists.  Returns NOTHING if there is no such left
- * child.
+/* Bubbles down the element at index 'nodeIndex' in minheap 'heap', if
+ * 'nodeIndex' is a valid index for heap. Has no effect otherwise.
+ * Note: like bubbleUp, this moves the smallest child up into the hole at
+ * every level and writes the element itself only once.
  */
-int leftIdx(MinHeap* heap, int nodeIndex){
-       if (nodeIndex*2 <= heap->size){
-              return nodeIndex*2;
-
+void bubbleDownFrom(MinHeap* heap, int nodeIndex){
+       if (nodeIndex < ROOT_INDEX || nodeIndex > heap->size){
+              return;
        }
-       else{
-              return NOTHING;
+       HeapNode node = nodeAt(heap,nodeIndex);
+       int childIndex = firstChildIdx(heap,nodeIndex);
+
+       while (childIndex != NOTHING){
+              // the children are adjacent: scan them for the smallest one
+              int lastChild = childIndex + heap->arity - 1;
+              if (lastChild > heap->size){
+                     lastChild = heap->size;
+              }
+              int minChild = childIndex;
+              for (int i = childIndex + 1; i <= lastChild; i++){
+                     if (priorityAt(heap,i) < priorityAt(heap,minChild)){
+                            minChild = i;
+                     }
+              }
+              if (priorityAt(heap,minChild) >= node.priority){
+                     break;
+              }
+              placeNode(heap,nodeIndex,nodeAt(heap,minChild));
+              nodeIndex = minChild;
+              childIndex = firstChildIdx(heap,nodeIndex);
        }
+       placeNode(heap,nodeIndex,node);
 }
 
-/* Returns the index of the right child of a node at index 'nodeIndex' in
- * minheap 'heap', if such exists.  Returns NOTHING if there is no such right
- * child.
+/* Returns the index of the first (leftmost) child of a node at index
+ * 'nodeIndex' in minheap 'heap', if such exists. The other children follow
+ * it at consecutive indices. Returns NOTHING if there are no children.
  */
-int rightIdx(MinHeap* heap, int nodeIndex){
-       if ((nodeIndex*2+1) <= heap->size){
-              return nodeIndex*2+1;
+int firstChildIdx(MinHeap* heap, int nodeIndex){
+       int childIndex = heap->arity*(nodeIndex-ROOT_INDEX) + ROOT_INDEX + 1;
+       if (childIndex <= heap->size){
+              return childIndex;
        }
        else{
               return NOTHING;
@@ -152,11 +113,11 @@ int rightIdx(MinHeap* heap, int nodeIndex){
  * 'heap', if such exists.  Returns NOTHING if there is no such parent.
  */
 int parentIdx(MinHeap* heap, int nodeIndex){
-       if (nodeIndex == 1){
+       if (nodeIndex == ROOT_INDEX){
               return NOTHING;
        }
        else{
-              return (int)(nodeIndex/2);
+              return (nodeIndex-ROOT_INDEX-1)/heap->arity + ROOT_INDEX;
        }
 }
 
@@ -225,14 +186,12 @@ HeapNode extractMin(MinHeap* heap){
        heap->arr[heap->size].id = NOTHING;
 
        heap->size = heap->size - 1;
-       heap->indexMap[minId] = NOTHING;
        heap->indexMap[lastNodeId] = ROOT_INDEX;
+       heap->indexMap[minId] = NOTHING;  // after the line above, in case
+                                         //   the min node was the last one
 
        bubbleDown(heap);
-       HeapNode* minNodeCopy = (HeapNode*)malloc(sizeof(HeapNode));
-       minNodeCopy->id = minNode.id;
-       minNodeCopy->priority = minNode.priority;
-       return *minNodeCopy;
+       return minNode;
 }
 
 /* Inserts a new node with priority 'priority' and ID 'id' into minheap 'heap'.
@@ -252,6 +211,13 @@ void insert(MinHeap* heap, int priority, int id){
        bubbleUp(heap,newIndex);
 }
 
+/* Returns True iff a node with ID 'id' is in minheap 'heap'.
+ * Precondition: 0 <= 'id' < heap->capacity
+ */
+bool isInHeap(MinHeap* heap, int id){
+       return heap->indexMap[id] != NOTHING;
+}
+
 /* Returns priority of the node with ID 'id' in 'heap'.
  * Precondition: 'id' is a valid node ID in 'heap'.
  */
@@ -287,14 +253,29 @@ bool decreasePriority(MinHeap* heap, int id, int newPriority){
  * Precondition: capacity >= 0
  */
 MinHeap* newHeap(int capacity){
+       return newHeapWithArity(capacity, 2);
+}
+
+/* Returns a newly created empty minheap with initial capacity 'capacity',
+ * in which every node has up to 'arity' children. With an arity of 4 or 8
+ * the children of a node share one cache line, and the heap is shallower,
+ * which makes insert and decreasePriority cheaper.
+ * Precondition: capacity >= 0
+ *               arity >= 2
+ */
+MinHeap* newHeapWithArity(int capacity, int arity){
        MinHeap *newHeap = malloc(sizeof(MinHeap));
        newHeap->size = 0;
        newHeap->capacity = capacity;
+       newHeap->arity = arity;
        int *indexMap = malloc((capacity+1)*sizeof(int));
        for (int i=0; i<=capacity; i++){
               indexMap[i] = NOTHING;
        }
-       HeapNode *arr = malloc((capacity+1)*sizeof(HeapNode));
+       // aligned_alloc needs a multiple of the alignment
+       size_t bytes = (ARR_PAD+capacity+1)*sizeof(HeapNode);
+       bytes = (bytes + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+       HeapNode *arr = (HeapNode*)aligned_alloc(CACHE_LINE, bytes) + ARR_PAD;
        for (int i=0; i<=capacity; i++){
               arr[i].id = NOTHING;
               arr[i].priority = NOTHING; 
@@ -304,11 +285,48 @@ MinHeap* newHeap(int capacity){
        return newHeap;
 }
 
+/* Returns a newly created minheap with capacity 'capacity' and arity
+ * 'arity' (see newHeapWithArity), holding the 'n' nodes with priorities
+ * 'priorities[i]' and IDs 'ids[i]'.
+ * Note: the nodes are placed as given and then heapified bottom-up, which
+ * takes O(n) time, instead of O(n log n) for 'n' calls to insert.
+ * Precondition: the IDs in 'ids' are unique and 0 <= ids[i] < capacity
+ *               0 <= n <= capacity
+ *               arity >= 2
+ */
+MinHeap* newHeapFromArray(int* priorities, int* ids, int n, int capacity,
+                          int arity){
+       MinHeap *heap = newHeapWithArity(capacity, arity);
+       for (int i=0; i<n; i++){
+              placeNode(heap,ROOT_INDEX+i,(HeapNode){priorities[i],ids[i]});
+       }
+       heap->size = n;
+       // leaves are heaps already: bubble down every inner node, last first
+       int lastInner = parentIdx(heap,heap->size);
+       for (int i=lastInner; i>=ROOT_INDEX; i--){
+              bubbleDownFrom(heap,i);
+       }
+       return heap;
+}
+
+/* Removes every node from minheap 'heap' in time linear in its size, so
+ * that the heap can be reused.
+ */
+void clearHeap(MinHeap* heap){
+       for (int i=ROOT_INDEX; i<=heap->size; i++){
+              heap->indexMap[idAt(heap,i)] = NOTHING;
+              heap->arr[i].priority = NOTHING;
+              heap->arr[i].id = NOTHING;
+       }
+       heap->size = 0;
+}
+
 /* Frees all memory allocated for minheap 'heap'.
  */
 void deleteHeap(MinHeap* heap){
        free(heap->indexMap);
-       free(heap->arr);
+       free(heap->arr - ARR_PAD);
+       free(heap);
 }
 
 /*********************************************************************
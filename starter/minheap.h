@@ -24,6 +24,8 @@ typedef struct min_heap {
   int capacity;   // the number of nodes that can be stored in this heap
   HeapNode* arr;  // the array that stores the nodes of this heap
   int* indexMap;  // indexMap[id] is the index of node with ID id in array arr
+  int arity;      // the maximum number of children of a node; the children
+                  //   of a node are stored next to each other in arr
 } MinHeap;
 
 /* Returns the node with minimum priority in minheap 'heap'.
@@ -43,6 +45,11 @@ HeapNode extractMin(MinHeap* heap);
  */
 void insert(MinHeap* heap, int priority, int id);
 
+/* Returns True iff a node with ID 'id' is in minheap 'heap'.
+ * Precondition: 0 <= 'id' < heap->capacity
+ */
+bool isInHeap(MinHeap* heap, int id);
+
 /* Returns priority of the node with ID 'id' in 'heap'.
  * Precondition: 'id' is a valid node ID in 'heap'.
  */
@@ -65,6 +72,31 @@ void printHeap(MinHeap* heap);
  */
 MinHeap* newHeap(int capacity);
 
+/* Returns a newly created empty minheap with initial capacity 'capacity',
+ * in which every node has up to 'arity' children. With an arity of 4 or 8
+ * the children of a node share one cache line, and the heap is shallower,
+ * which makes insert and decreasePriority cheaper.
+ * Precondition: capacity >= 0
+ *               arity >= 2
+ */
+MinHeap* newHeapWithArity(int capacity, int arity);
+
+/* Returns a newly created minheap with capacity 'capacity' and arity
+ * 'arity' (see newHeapWithArity), holding the 'n' nodes with priorities
+ * 'priorities[i]' and IDs 'ids[i]'. Takes O(n) time, so it is faster than
+ * 'n' calls to insert.
+ * Precondition: the IDs in 'ids' are unique and 0 <= ids[i] < capacity
+ *               0 <= n <= capacity
+ *               arity >= 2
+ */
+MinHeap* newHeapFromArray(int* priorities, int* ids, int n, int capacity,
+                          int arity);
+
+/* Removes every node from minheap 'heap' in time linear in its size, so
+ * that the heap can be reused.
+ */
+void clearHeap(MinHeap* heap);
+
 /* Frees all memory allocated for minheap 'heap'.
  */
 void deleteHeap(MinHeap* heap);
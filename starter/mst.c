@@ -0,0 +1,674 @@
+/*
+ * Our minimum spanning tree algorithms other than Prim's.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "mst.h"
+
+#define NOTHING -1
+#define NO_EDGE UINT64_MAX  // no lightest edge picked yet
+#define VERTEX_CHUNK 1024   // vertices a thread takes at a time
+#define KRUSKAL_SORT_MAX 1024  // Filter-Kruskal sorts edge ranges up to this
+                               //   size instead of splitting them further
+#define RADIX_BITS 8           // the radix sort sorts this many bits a pass
+#define RADIX_SIZE (1 << RADIX_BITS)
+
+typedef struct disjoint_sets {  // union-find over IDs 0, 1, ..., size-1
+  int* parent;  // parent[id] is the parent of id, or id for a root
+  int* rank;    // rank[root] bounds the height of the tree of root
+} DisjointSets;
+
+typedef struct kruskal {  // state of Kruskal's algorithm
+  DisjointSets sets;      // the components of the tree so far
+  Edge* tree;             // the MST found so far
+  int numTreeEdges;       // number of edges in 'tree'
+  int maxTreeEdges;       // the tree is complete with this many edges
+  Edge* buffer;           // scratch space for the radix sort
+} Kruskal;
+
+typedef struct boruvka {  // state shared by all threads of Boruvka's
+  CSRGraph* graph;        // the graph, read-only
+  _Atomic int* parent;    // concurrent union-find over the vertices:
+                          //   parent[id] is id for the root of a component
+  _Atomic uint64_t* lightest;  // lightest[root] is the lightest edge leaving
+                               //   the component of root as
+                               //   (from << 32 | edge index), or NO_EDGE
+  Edge* tree;             // the MST found so far
+  atomic_int numTreeEdges;  // number of edges in 'tree'
+  atomic_int nextVertex;  // first vertex of the current phase no thread
+                          //   has taken yet
+  void (*phase)(struct boruvka*, int, int);  // the current phase, run on
+                                             //   a range of vertices
+} Boruvka;
+
+/*************************************************************************
+ ** Helper functions
+ *************************************************************************/
+
+/* Returns the root of the component of vertex 'v' in 'mst', halving the
+ * path to it on the way. Other threads may link roots at the same time.
+ */
+int findRoot(Boruvka* mst, int v){
+  int p = atomic_load(&mst->parent[v]);
+  while (p != v){
+    int grandparent = atomic_load(&mst->parent[p]);
+    if (grandparent != p){
+      int expected = p;  // a failed exchange only skips one halving step
+      atomic_compare_exchange_weak(&mst->parent[v], &expected, grandparent);
+    }
+    v = p;
+    p = atomic_load(&mst->parent[v]);
+  }
+  return v;
+}
+
+/* Merges the components of vertices 'u' and 'v' in 'mst', and returns true,
+ * or returns false if they are in one component already.
+ */
+bool uniteRoots(Boruvka* mst, int u, int v){
+  while (true){
+    u = findRoot(mst, u);
+    v = findRoot(mst, v);
+    if (u == v){
+      return false;
+    }
+    if (u < v){  // link the larger root below the smaller one
+      int t = u;
+      u = v;
+      v = t;
+    }
+    int expected = u;
+    if (atomic_compare_exchange_strong(&mst->parent[u], &expected, v)){
+      return true;
+    }
+  }
+}
+
+/* Returns true iff edge index 'e' leaving vertex 'u' is lighter than edge
+ * index 'f' leaving vertex 'v' in 'graph'. Edges of equal weight are ordered
+ * by their ends, which is the same for both directions of an edge: all
+ * components then agree on the order, and the edges they pick never close
+ * a cycle.
+ */
+bool isLighter(CSRGraph* graph, int u, int e, int v, int f){
+  if (graph->weights[e] != graph->weights[f]){
+    return graph->weights[e] < graph->weights[f];
+  }
+  int minE = u < graph->targets[e] ? u : graph->targets[e];
+  int maxE = u < graph->targets[e] ? graph->targets[e] : u;
+  int minF = v < graph->targets[f] ? v : graph->targets[f];
+  int maxF = v < graph->targets[f] ? graph->targets[f] : v;
+  if (minE != minF){
+    return minE < minF;
+  }
+  return maxE < maxF;
+}
+
+/* Offers edge index 'e' leaving vertex 'u' as the lightest edge leaving the
+ * component with root 'root' in 'mst'.
+ */
+void offerEdge(Boruvka* mst, int root, int u, int e){
+  uint64_t candidate = (uint64_t)u << 32 | (uint32_t)e;
+  uint64_t current = atomic_load(&mst->lightest[root]);
+  // on failure, 'current' is reloaded: retry while 'e' is still lighter
+  while (current == NO_EDGE ||
+         isLighter(mst->graph, u, e, (int)(current >> 32),
+                   (int)(uint32_t)current)){
+    if (atomic_compare_exchange_weak(&mst->lightest[root], &current,
+                                     candidate)){
+      return;
+    }
+  }
+}
+
+/* First phase of a round: offers every edge leaving vertices 'first' to
+ * 'last'-1 that leads to another component to the component of its start.
+ */
+void findLightestEdges(Boruvka* mst, int first, int last){
+  CSRGraph* graph = mst->graph;
+  for (int u = first; u < last; u++){
+    int rootU = findRoot(mst, u);
+    for (int e = graph->offsets[u]; e < graph->offsets[u+1]; e++){
+      if (findRoot(mst, graph->targets[e]) != rootU){
+        offerEdge(mst, rootU, u, e);
+      }
+    }
+  }
+}
+
+/* Second phase of a round: adds the lightest edge of every component whose
+ * root is among vertices 'first' to 'last'-1 to the tree, unless the other
+ * end of the edge has already picked the same edge, and merges the
+ * components it joins.
+ */
+void addLightestEdges(Boruvka* mst, int first, int last){
+  CSRGraph* graph = mst->graph;
+  for (int root = first; root < last; root++){
+    uint64_t edge = atomic_load(&mst->lightest[root]);
+    if (edge == NO_EDGE){
+      continue;
+    }
+    atomic_store(&mst->lightest[root], NO_EDGE);
+    int u = (int)(edge >> 32);
+    int e = (int)(uint32_t)edge;
+    if (uniteRoots(mst, u, graph->targets[e])){
+      int i = atomic_fetch_add(&mst->numTreeEdges, 1);
+      mst->tree[i].fromVertex = u;
+      mst->tree[i].toVertex = graph->targets[e];
+      mst->tree[i].weight = graph->weights[e];
+    }
+  }
+}
+
+/* Runs the current phase of 'arg', a Boruvka, on VERTEX_CHUNK vertices at a
+ * time until no vertices are left.
+ */
+void* runBoruvkaWorker(void* arg){
+  Boruvka* mst = arg;
+  int numVertices = mst->graph->numVertices;
+  while (true){
+    int first = atomic_fetch_add(&mst->nextVertex, VERTEX_CHUNK);
+    if (first >= numVertices){
+      break;
+    }
+    int last = first + VERTEX_CHUNK < numVertices ?
+               first + VERTEX_CHUNK : numVertices;
+    mst->phase(mst, first, last);
+  }
+  return NULL;
+}
+
+/* Runs 'phase' over all vertices of 'mst' on 'numThreads' threads, the
+ * calling one included, and returns when it is done.
+ */
+void runBoruvkaPhase(Boruvka* mst, void (*phase)(Boruvka*, int, int),
+                     int numThreads){
+  mst->phase = phase;
+  atomic_store(&mst->nextVertex, 0);
+  pthread_t* threads = malloc(sizeof(pthread_t)*numThreads);
+  // if a thread cannot be started, the others take over its share
+  int numStarted = 1;
+  while (numStarted < numThreads &&
+         pthread_create(&threads[numStarted], NULL, runBoruvkaWorker,
+                        mst) == 0){
+    numStarted++;
+  }
+  runBoruvkaWorker(mst);
+  for (int i = 1; i < numStarted; i++){
+    pthread_join(threads[i], NULL);
+  }
+  free(threads);
+}
+
+/* Makes 'sets' hold 'size' sets, one for each of IDs 0, 1, ..., size-1. */
+void initDisjointSets(DisjointSets* sets, int size){
+  sets->parent = malloc(sizeof(int)*size);
+  sets->rank = malloc(sizeof(int)*size);
+  for (int i = 0; i < size; i++){
+    sets->parent[i] = i;
+    sets->rank[i] = 0;
+  }
+}
+
+/* Frees all memory allocated for the sets in 'sets'. */
+void freeDisjointSets(DisjointSets* sets){
+  free(sets->parent);
+  free(sets->rank);
+}
+
+/* Returns the root of the set of 'id' in 'sets', pointing every ID on the
+ * way straight at it.
+ */
+int findSet(DisjointSets* sets, int id){
+  int root = id;
+  while (sets->parent[root] != root){
+    root = sets->parent[root];
+  }
+  while (sets->parent[id] != root){
+    int next = sets->parent[id];
+    sets->parent[id] = root;
+    id = next;
+  }
+  return root;
+}
+
+/* Merges the sets of 'a' and 'b' in 'sets', the lower-ranked root below the
+ * other, and returns true, or returns false if they are one set already.
+ */
+bool unionSets(DisjointSets* sets, int a, int b){
+  a = findSet(sets, a);
+  b = findSet(sets, b);
+  if (a == b){
+    return false;
+  }
+  if (sets->rank[a] < sets->rank[b]){
+    int t = a;
+    a = b;
+    b = t;
+  }
+  sets->parent[b] = a;
+  if (sets->rank[a] == sets->rank[b]){
+    sets->rank[a]++;
+  }
+  return true;
+}
+
+/* Returns the radix sort key of 'weight': its bits, with the sign bit
+ * flipped so that negative weights come first.
+ */
+uint32_t weightKey(int weight){
+  return (uint32_t)weight ^ 0x80000000u;
+}
+
+/* Sorts the 'n' edges in 'edges' by weight, stably, a byte at a time from
+ * the lowest, using 'buffer' of room for 'n' edges. Skips every byte that
+ * all weights share.
+ */
+void radixSortEdges(Edge* edges, int n, Edge* buffer){
+  Edge* from = edges;
+  Edge* to = buffer;
+  for (int shift = 0; shift < 32; shift += RADIX_BITS){
+    int count[RADIX_SIZE] = {0};
+    for (int i = 0; i < n; i++){
+      count[(weightKey(from[i].weight) >> shift) & (RADIX_SIZE-1)]++;
+    }
+    if (n == 0 ||
+        count[(weightKey(from[0].weight) >> shift) & (RADIX_SIZE-1)] == n){
+      continue;
+    }
+    int start = 0;
+    for (int d = 0; d < RADIX_SIZE; d++){
+      int c = count[d];
+      count[d] = start;
+      start += c;
+    }
+    for (int i = 0; i < n; i++){
+      to[count[(weightKey(from[i].weight) >> shift) & (RADIX_SIZE-1)]++] =
+          from[i];
+    }
+    Edge* t = from;
+    from = to;
+    to = t;
+  }
+  if (from != edges){
+    for (int i = 0; i < n; i++){
+      edges[i] = from[i];
+    }
+  }
+}
+
+/* Sorts the 'n' edges in 'edges' and adds each that joins two components to
+ * the tree of 'mst', lightest first, until the tree is complete.
+ */
+void kruskalSorted(Kruskal* mst, Edge* edges, int n){
+  radixSortEdges(edges, n, mst->buffer);
+  for (int i = 0; i < n && mst->numTreeEdges < mst->maxTreeEdges; i++){
+    if (unionSets(&mst->sets, edges[i].fromVertex, edges[i].toVertex)){
+      mst->tree[mst->numTreeEdges++] = edges[i];
+    }
+  }
+}
+
+/* Runs Filter-Kruskal on the 'n' edges in 'edges' for the tree of 'mst':
+ * splits them around the weight of a middle edge, recurses on the light
+ * ones, drops the heavy ones whose ends are now connected, and recurses on
+ * the rest. Reorders 'edges'.
+ */
+void filterKruskal(Kruskal* mst, Edge* edges, int n){
+  if (mst->numTreeEdges == mst->maxTreeEdges){
+    return;
+  }
+  if (n <= KRUSKAL_SORT_MAX){
+    kruskalSorted(mst, edges, n);
+    return;
+  }
+  // median of three as the pivot
+  int a = edges[0].weight;
+  int b = edges[n/2].weight;
+  int c = edges[n-1].weight;
+  int pivot = a < b ? (b < c ? b : (a < c ? c : a))
+                    : (a < c ? a : (b < c ? c : b));
+  int numLight = 0;
+  for (int i = 0; i < n; i++){
+    if (edges[i].weight <= pivot){
+      Edge t = edges[numLight];
+      edges[numLight++] = edges[i];
+      edges[i] = t;
+    }
+  }
+  if (numLight == n){  // the pivot is the heaviest: no split to be had
+    kruskalSorted(mst, edges, n);
+    return;
+  }
+  filterKruskal(mst, edges, numLight);
+
+  Edge* heavy = edges + numLight;
+  int numHeavy = 0;
+  for (int i = 0; i < n - numLight; i++){
+    if (findSet(&mst->sets, heavy[i].fromVertex) !=
+        findSet(&mst->sets, heavy[i].toVertex)){
+      heavy[numHeavy++] = heavy[i];
+    }
+  }
+  filterKruskal(mst, heavy, numHeavy);
+}
+
+/* Returns the edges of 'graph' taken as undirected, as
+ * getConnectedComponents takes them: one edge (u -- v, w) with u < v for
+ * every two vertices joined by an edge in either direction, with the least
+ * weight of those edges. Self-loops are left out. Stores the number of
+ * edges in '*numEdges'. Takes O(numVertices + numEdges) time.
+ */
+Edge* undirectedEdges(CSRGraph* graph, int* numEdges){
+  int numVertices = graph->numVertices;
+
+  // counting sort of the edges by their smaller end, as in reverseCSRGraph
+  int* start = calloc(numVertices + 1, sizeof(int));
+  for (int u = 0; u < numVertices; u++){
+    for (int e = graph->offsets[u]; e < graph->offsets[u+1]; e++){
+      int v = graph->targets[e];
+      if (u != v){
+        start[(u < v ? u : v) + 1]++;
+      }
+    }
+  }
+  for (int u = 0; u < numVertices; u++){
+    start[u+1] += start[u];
+  }
+  int* next = malloc(sizeof(int)*(numVertices > 0 ? numVertices : 1));
+  for (int u = 0; u < numVertices; u++){
+    next[u] = start[u];
+  }
+  Edge* edges = malloc(sizeof(Edge)*(start[numVertices] > 0 ?
+                                     start[numVertices] : 1));
+  for (int u = 0; u < numVertices; u++){
+    for (int e = graph->offsets[u]; e < graph->offsets[u+1]; e++){
+      int v = graph->targets[e];
+      if (u < v){
+        edges[next[u]++] = (Edge){u, v, graph->weights[e]};
+      }
+      else if (u > v){
+        edges[next[v]++] = (Edge){v, u, graph->weights[e]};
+      }
+    }
+  }
+
+  // keep the lightest edge per pair: within the edges of u, kept[v] is
+  // where the edge (u -- v) went, if owner[v] is u
+  int* owner = next;  // no longer needed as such
+  int* kept = malloc(sizeof(int)*(numVertices > 0 ? numVertices : 1));
+  for (int v = 0; v < numVertices; v++){
+    owner[v] = NOTHING;
+  }
+  int count = 0;
+  for (int u = 0; u < numVertices; u++){
+    for (int i = start[u]; i < start[u+1]; i++){
+      int v = edges[i].toVertex;
+      if (owner[v] != u){
+        owner[v] = u;
+        kept[v] = count;
+        edges[count++] = edges[i];
+      }
+      else if (edges[i].weight < edges[kept[v]].weight){
+        edges[kept[v]].weight = edges[i].weight;
+      }
+    }
+  }
+  *numEdges = count;
+
+  free(kept);
+  free(next);
+  free(start);
+  return edges;
+}
+
+/* Runs Filter-Kruskal on 'graph', taking every edge as undirected (see
+ * undirectedEdges), until the tree has 'maxTreeEdges' edges or no edges
+ * are left, and returns it: an array of numVertices Edges, in the order
+ * they join the tree, followed by (-1 -- -1, -1) entries. Stores the
+ * number of tree edges in '*numTreeEdges' if it is not NULL.
+ */
+Edge* kruskalForest(CSRGraph* graph, int maxTreeEdges, int* numTreeEdges){
+  int numVertices = graph->numVertices;
+  int numEdges;
+  Edge* edges = undirectedEdges(graph, &numEdges);
+
+  Kruskal mst;
+  mst.maxTreeEdges = maxTreeEdges;
+  initDisjointSets(&mst.sets, numVertices);
+  // as for Prim's: room for one edge per vertex, all but one used
+  mst.tree = malloc(sizeof(Edge)*numVertices);
+  for (int i = 0; i < numVertices; i++){
+    mst.tree[i].fromVertex = NOTHING;
+    mst.tree[i].toVertex = NOTHING;
+    mst.tree[i].weight = NOTHING;
+  }
+  mst.numTreeEdges = 0;
+  mst.buffer = malloc(sizeof(Edge)*(numEdges > 0 ? numEdges : 1));
+
+  filterKruskal(&mst, edges, numEdges);
+
+  if (numTreeEdges != NULL){
+    *numTreeEdges = mst.numTreeEdges;
+  }
+  free(mst.buffer);
+  freeDisjointSets(&mst.sets);
+  free(edges);
+  return mst.tree;
+}
+
+/*********************************************************************
+ * Required functions
+ ********************************************************************/
+/* Runs Boruvka's algorithm on Graph 'graph' on 'numThreads' threads at
+ * once, and returns the resulting MST: an array of Edges, as getMSTprim
+ * does, but in no particular order and with each edge (u -- v, w) picked by
+ * the component of u. If 'numThreads' is not positive, uses one thread per
+ * online processor.
+ * Returns NULL if 'graph' has no vertices.
+ * Precondition: 'graph' is connected.
+ *               every edge (u -- v, w) has a reverse edge (v -- u, w)
+ */
+Edge* getMSTboruvka(Graph* graph, int numThreads){
+  if (graph == NULL || graph->numVertices < 1){
+    return NULL;
+  }
+  CSRGraph* csr = freezeGraph(graph);
+  Edge* tree = getMSTboruvkaCSR(csr, numThreads);
+  deleteCSRGraph(csr);
+  return tree;
+}
+
+/* Same as getMSTboruvka, but runs on the frozen graph 'graph'. */
+Edge* getMSTboruvkaCSR(CSRGraph* graph, int numThreads){
+  if (graph == NULL || graph->numVertices < 1){
+    return NULL;
+  }
+  int numVertices = graph->numVertices;
+  if (numThreads <= 0){
+    numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  // a thread per chunk of vertices at most
+  int numChunks = (numVertices + VERTEX_CHUNK - 1)/VERTEX_CHUNK;
+  if (numThreads > numChunks){
+    numThreads = numChunks;
+  }
+
+  Boruvka mst;
+  mst.graph = graph;
+  mst.parent = malloc(sizeof(_Atomic int)*numVertices);
+  mst.lightest = malloc(sizeof(_Atomic uint64_t)*numVertices);
+  for (int i = 0; i < numVertices; i++){
+    atomic_init(&mst.parent[i], i);
+    atomic_init(&mst.lightest[i], NO_EDGE);
+  }
+  // as for Prim's: room for one edge per vertex, all but one used
+  mst.tree = malloc(sizeof(Edge)*numVertices);
+  for (int i = 0; i < numVertices; i++){
+    mst.tree[i].fromVertex = NOTHING;
+    mst.tree[i].toVertex = NOTHING;
+    mst.tree[i].weight = NOTHING;
+  }
+  atomic_init(&mst.numTreeEdges, 0);
+
+  // stop once a round adds no edge: then no component has an edge leaving
+  int numTreeEdges = NOTHING;
+  while (numTreeEdges != atomic_load(&mst.numTreeEdges)){
+    numTreeEdges = atomic_load(&mst.numTreeEdges);
+    runBoruvkaPhase(&mst, findLightestEdges, numThreads);
+    runBoruvkaPhase(&mst, addLightestEdges, numThreads);
+  }
+
+  free(mst.parent);
+  free(mst.lightest);
+  return mst.tree;
+}
+
+/* Runs Filter-Kruskal on Graph 'graph', sorting edges by weight with a
+ * radix sort, and returns the resulting MST: an array of Edges, as
+ * getMSTprim does, but in the order they join the tree. Every edge is taken
+ * as undirected; of several edges between the same two vertices, only the
+ * lightest counts.
+ * Returns NULL if 'graph' has no vertices.
+ * Precondition: 'graph' is connected.
+ */
+Edge* getMSTkruskal(Graph* graph){
+  if (graph == NULL || graph->numVertices < 1){
+    return NULL;
+  }
+  CSRGraph* csr = freezeGraph(graph);
+  Edge* tree = getMSTkruskalCSR(csr);
+  deleteCSRGraph(csr);
+  return tree;
+}
+
+/* Same as getMSTkruskal, but runs on the frozen graph 'graph'. */
+Edge* getMSTkruskalCSR(CSRGraph* graph){
+  if (graph == NULL || graph->numVertices < 1){
+    return NULL;
+  }
+  return kruskalForest(graph, graph->numVertices - 1, NULL);
+}
+
+/* Labels the connected components of Graph 'graph', taking every edge as
+ * undirected, and returns the labels: component[id] is the component of
+ * vertex id, numbered 0, 1, ..., *numComponents-1 in order of their
+ * smallest vertex. Stores the number of components in '*numComponents'.
+ * Takes O(numVertices + numEdges) time, up to the inverse Ackermann
+ * factor of the union-find.
+ * Returns NULL if 'graph' has no vertices.
+ */
+int* getConnectedComponents(Graph* graph, int* numComponents){
+  if (graph == NULL || graph->numVertices < 1){
+    return NULL;
+  }
+  CSRGraph* csr = freezeGraph(graph);
+  int* component = getConnectedComponentsCSR(csr, numComponents);
+  deleteCSRGraph(csr);
+  return component;
+}
+
+/* Same as getConnectedComponents, but runs on the frozen graph 'graph'. */
+int* getConnectedComponentsCSR(CSRGraph* graph, int* numComponents){
+  if (graph == NULL || graph->numVertices < 1){
+    return NULL;
+  }
+  int numVertices = graph->numVertices;
+  DisjointSets sets;
+  initDisjointSets(&sets, numVertices);
+  for (int u = 0; u < numVertices; u++){
+    for (int e = graph->offsets[u]; e < graph->offsets[u+1]; e++){
+      unionSets(&sets, u, graph->targets[e]);
+    }
+  }
+
+  // label[root] is the label of the component of root, once it is known
+  int* label = malloc(sizeof(int)*numVertices);
+  int* component = malloc(sizeof(int)*numVertices);
+  for (int i = 0; i < numVertices; i++){
+    label[i] = NOTHING;
+  }
+  int count = 0;
+  for (int v = 0; v < numVertices; v++){
+    int root = findSet(&sets, v);
+    if (label[root] == NOTHING){
+      label[root] = count++;
+    }
+    component[v] = label[root];
+  }
+  *numComponents = count;
+
+  free(label);
+  freeDisjointSets(&sets);
+  return component;
+}
+
+/* Labels the connected components of Graph 'graph' and returns a minimum
+ * spanning tree of each: the minimum spanning forest of 'graph'. The tree
+ * of a component with a single vertex has no edges. As for the components,
+ * every edge is taken as undirected, as in getMSTkruskal.
+ * Returns NULL if 'graph' has no vertices.
+ */
+SpanningForest* getMinimumSpanningForest(Graph* graph){
+  if (graph == NULL || graph->numVertices < 1){
+    return NULL;
+  }
+  CSRGraph* csr = freezeGraph(graph);
+  SpanningForest* forest = getMinimumSpanningForestCSR(csr);
+  deleteCSRGraph(csr);
+  return forest;
+}
+
+/* Same as getMinimumSpanningForest, but runs on the frozen graph 'graph'. */
+SpanningForest* getMinimumSpanningForestCSR(CSRGraph* graph){
+  if (graph == NULL || graph->numVertices < 1){
+    return NULL;
+  }
+  int numVertices = graph->numVertices;
+  SpanningForest* forest = malloc(sizeof(SpanningForest));
+  forest->numVertices = numVertices;
+  forest->component = getConnectedComponentsCSR(graph,
+                                                &forest->numComponents);
+  int numComponents = forest->numComponents;
+
+  // knowing the number of components, Kruskal's can stop as soon as the
+  // forest is complete
+  int numTreeEdges;
+  Edge* edges = kruskalForest(graph, numVertices - numComponents,
+                              &numTreeEdges);
+
+  // group the edges by component, keeping their order within each
+  forest->treeStarts = calloc(numComponents + 1, sizeof(int));
+  for (int i = 0; i < numTreeEdges; i++){
+    forest->treeStarts[forest->component[edges[i].fromVertex] + 1]++;
+  }
+  for (int c = 0; c < numComponents; c++){
+    forest->treeStarts[c+1] += forest->treeStarts[c];
+  }
+  int* next = malloc(sizeof(int)*(numComponents > 0 ? numComponents : 1));
+  for (int c = 0; c < numComponents; c++){
+    next[c] = forest->treeStarts[c];
+  }
+  forest->edges = malloc(sizeof(Edge)*(numTreeEdges > 0 ? numTreeEdges : 1));
+  for (int i = 0; i < numTreeEdges; i++){
+    forest->edges[next[forest->component[edges[i].fromVertex]]++] = edges[i];
+  }
+
+  free(next);
+  free(edges);
+  return forest;
+}
+
+/* Frees all memory allocated for 'forest'.
+ */
+void deleteSpanningForest(SpanningForest* forest){
+  if (forest == NULL) return;
+  free(forest->component);
+  free(forest->treeStarts);
+  free(forest->edges);
+  free(forest);
+}
@@ -0,0 +1,91 @@
+/*
+ * Header file for our minimum spanning tree algorithms other than Prim's,
+ * and for spanning forests of graphs that are not connected.
+ *
+ * Boruvka's algorithm starts with every vertex as a component of its own.
+ * Each round, every component picks the lightest edge leaving it, and all
+ * picked edges join the tree at once. Every round at least halves the
+ * number of components, and the work of a round is independent per vertex,
+ * so it spreads over threads.
+ *
+ * Kruskal's algorithm adds edges lightest first, skipping those whose ends
+ * are connected already. Filter-Kruskal sorts lazily: it splits the edges
+ * around a pivot weight, runs on the light part first, and then drops every
+ * heavy edge that the light edges have already made useless, so heavy edges
+ * are mostly never sorted.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph.h"
+
+#ifndef __MST_header
+#define __MST_header
+
+typedef struct spanning_forest {  // a minimum spanning tree per component
+  int numVertices;    // total number of vertices in the graph
+  int numComponents;  // number of connected components of the graph
+  int* component;     // component[id] is the component of vertex id
+  int* treeStarts;    // the tree of component c is the treeStarts[c+1] -
+                      //   treeStarts[c] edges from edges[treeStarts[c]]
+  Edge* edges;        // the edges of all trees, tree by tree
+} SpanningForest;
+
+/* Runs Boruvka's algorithm on Graph 'graph' on 'numThreads' threads at
+ * once, and returns the resulting MST: an array of Edges, as getMSTprim
+ * does, but in no particular order and with each edge (u -- v, w) picked by
+ * the component of u. If 'numThreads' is not positive, uses one thread per
+ * online processor.
+ * Returns NULL if 'graph' has no vertices.
+ * Precondition: 'graph' is connected.
+ *               every edge (u -- v, w) has a reverse edge (v -- u, w)
+ */
+Edge* getMSTboruvka(Graph* graph, int numThreads);
+
+/* Same as getMSTboruvka, but runs on the frozen graph 'graph'. */
+Edge* getMSTboruvkaCSR(CSRGraph* graph, int numThreads);
+
+/* Runs Filter-Kruskal on Graph 'graph', sorting edges by weight with a
+ * radix sort, and returns the resulting MST: an array of Edges, as
+ * getMSTprim does, but in the order they join the tree. Every edge is taken
+ * as undirected; of several edges between the same two vertices, only the
+ * lightest counts.
+ * Returns NULL if 'graph' has no vertices.
+ * Precondition: 'graph' is connected.
+ */
+Edge* getMSTkruskal(Graph* graph);
+
+/* Same as getMSTkruskal, but runs on the frozen graph 'graph'. */
+Edge* getMSTkruskalCSR(CSRGraph* graph);
+
+/* Labels the connected components of Graph 'graph', taking every edge as
+ * undirected, and returns the labels: component[id] is the component of
+ * vertex id, numbered 0, 1, ..., *numComponents-1 in order of their
+ * smallest vertex. Stores the number of components in '*numComponents'.
+ * Takes O(numVertices + numEdges) time, up to the inverse Ackermann
+ * factor of the union-find.
+ * Returns NULL if 'graph' has no vertices.
+ */
+int* getConnectedComponents(Graph* graph, int* numComponents);
+
+/* Same as getConnectedComponents, but runs on the frozen graph 'graph'. */
+int* getConnectedComponentsCSR(CSRGraph* graph, int* numComponents);
+
+/* Labels the connected components of Graph 'graph' and returns a minimum
+ * spanning tree of each: the minimum spanning forest of 'graph'. The tree
+ * of a component with a single vertex has no edges. As for the components,
+ * every edge is taken as undirected, as in getMSTkruskal.
+ * Returns NULL if 'graph' has no vertices.
+ */
+SpanningForest* getMinimumSpanningForest(Graph* graph);
+
+/* Same as getMinimumSpanningForest, but runs on the frozen graph 'graph'. */
+SpanningForest* getMinimumSpanningForestCSR(CSRGraph* graph);
+
+/* Frees all memory allocated for 'forest'.
+ */
+void deleteSpanningForest(SpanningForest* forest);
+
+#endif
@@ -0,0 +1,143 @@
+/*
+ * Our MultiQueue implementation.
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "multiqueue.h"
+
+#define EMPTY INT_MAX  // cached minimum priority of an empty heap
+#define HEAP_ARITY 4   // children per node of every heap
+
+/*************************************************************************
+ ** Helper functions
+ *************************************************************************/
+
+/* Returns a pseudo-random number from a generator private to the calling
+ * thread.
+ */
+static uint32_t nextRandom(void){
+  static _Thread_local uint32_t state = 0;
+  if (state == 0){
+    // every thread has its own 'state', at its own address
+    state = (uint32_t)(uintptr_t)&state | 1;
+  }
+  // xorshift32
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+/* Refreshes the cached minimum priority of 'heap'.
+ * Precondition: the caller holds heap->lock
+ */
+static void updateMinPriority(LockedHeap* heap){
+  int priority = heap->heap->size > 0 ? getMin(heap->heap).priority : EMPTY;
+  atomic_store_explicit(&heap->minPriority, priority, memory_order_relaxed);
+}
+
+/* Returns the cached minimum priority of 'heap'. */
+static int minPriorityOf(LockedHeap* heap){
+  return atomic_load_explicit(&heap->minPriority, memory_order_relaxed);
+}
+
+/*********************************************************************
+ * Required functions
+ ********************************************************************/
+/* Inserts a node with priority 'priority' and ID 'id' into MultiQueue
+ * 'queue'. If 'queue' holds a node with ID 'id' already, lowers the
+ * priority of that node to 'priority' instead, if it is larger.
+ * Precondition: 0 <= 'id' < queue->capacity
+ *               priority < INT_MAX
+ */
+void multiQueueInsert(MultiQueue* queue, int priority, int id){
+  LockedHeap* heap = &queue->heaps[id % queue->numHeaps];
+  int localId = id / queue->numHeaps;
+  pthread_mutex_lock(&heap->lock);
+
+  if (isInHeap(heap->heap, localId)){
+    decreasePriority(heap->heap, localId, priority);
+  }
+  else {
+    insert(heap->heap, priority, localId);
+    atomic_fetch_add(&queue->size, 1);
+  }
+  updateMinPriority(heap);
+  pthread_mutex_unlock(&heap->lock);
+}
+
+/* Removes a node with a small priority from MultiQueue 'queue', stores it in
+ * '*node' and returns true, or returns false if 'queue' is empty. The node
+ * is the minimum of one of two randomly chosen heaps.
+ */
+bool multiQueueExtractMin(MultiQueue* queue, HeapNode* node){
+  while (atomic_load(&queue->size) > 0){
+    LockedHeap* first = &queue->heaps[nextRandom() % queue->numHeaps];
+    LockedHeap* second = &queue->heaps[nextRandom() % queue->numHeaps];
+    LockedHeap* heap = minPriorityOf(second) < minPriorityOf(first) ?
+                       second : first;
+    if (minPriorityOf(heap) == EMPTY ||
+        pthread_mutex_trylock(&heap->lock) != 0){
+      continue;
+    }
+    if (heap->heap->size == 0){  // emptied since its minimum was read
+      pthread_mutex_unlock(&heap->lock);
+      continue;
+    }
+    *node = extractMin(heap->heap);
+    node->id = node->id * queue->numHeaps + (int)(heap - queue->heaps);
+    updateMinPriority(heap);
+    pthread_mutex_unlock(&heap->lock);
+    atomic_fetch_sub(&queue->size, 1);
+    return true;
+  }
+  return false;
+}
+
+/* Returns the number of nodes in MultiQueue 'queue'. */
+int multiQueueSize(MultiQueue* queue){
+  return atomic_load(&queue->size);
+}
+
+/* Returns a newly created empty MultiQueue of 'numHeaps' heaps for nodes with
+ * IDs 0, 1, ..., 'capacity'-1. If 'numHeaps' is not positive, uses two heaps
+ * per online processor.
+ * Precondition: capacity >= 0
+ */
+MultiQueue* newMultiQueue(int capacity, int numHeaps){
+  if (numHeaps <= 0){
+    numHeaps = 2*(int)sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  if (numHeaps < 1){
+    numHeaps = 1;
+  }
+  MultiQueue* queue = malloc(sizeof(MultiQueue));
+  queue->numHeaps = numHeaps;
+  queue->capacity = capacity;
+  // sizeof(LockedHeap) is a multiple of its alignment
+  queue->heaps = aligned_alloc(_Alignof(LockedHeap),
+                               sizeof(LockedHeap)*numHeaps);
+  // heap i holds IDs i, i + numHeaps, i + 2*numHeaps, ...
+  int share = capacity / numHeaps + 1;
+  for (int i = 0; i < numHeaps; i++){
+    pthread_mutex_init(&queue->heaps[i].lock, NULL);
+    queue->heaps[i].heap = newHeapWithArity(share, HEAP_ARITY);
+    atomic_init(&queue->heaps[i].minPriority, EMPTY);
+  }
+  atomic_init(&queue->size, 0);
+  return queue;
+}
+
+/* Frees all memory allocated for MultiQueue 'queue'.
+ */
+void deleteMultiQueue(MultiQueue* queue){
+  for (int i = 0; i < queue->numHeaps; i++){
+    pthread_mutex_destroy(&queue->heaps[i].lock);
+    deleteHeap(queue->heaps[i].heap);
+  }
+  free(queue->heaps);
+  free(queue);
+}
@@ -0,0 +1,68 @@
+/*
+ * Header file for our MultiQueue: a relaxed concurrent priority queue.
+ *
+ * A MultiQueue is several minheaps, each behind its own lock. insert puts a
+ * node into the heap its ID belongs to, which spreads the IDs over all
+ * heaps; extractMin looks at the minimum of two random heaps and extracts
+ * from the better one. Threads rarely contend for the same heap, so no
+ * operation waits on a global lock; in exchange, extractMin returns a node
+ * close to, but not always exactly, the minimum.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "minheap.h"
+
+#ifndef __MultiQueue_header
+#define __MultiQueue_header
+
+typedef struct locked_heap {    // one heap of a MultiQueue
+  _Alignas(64) pthread_mutex_t lock;  // guards 'heap'; each LockedHeap has
+                                      //   a cache line of its own
+  MinHeap* heap;                // the nodes of this heap
+  atomic_int minPriority;       // priority of the root of 'heap', or INT_MAX
+                                //   if 'heap' is empty; read without 'lock'
+} LockedHeap;
+
+typedef struct multi_queue {
+  int numHeaps;       // number of heaps in 'heaps'
+  int capacity;       // node IDs are 0, 1, ..., capacity-1
+  LockedHeap* heaps;  // the heaps; the node with ID id is in heap
+                      //   id % numHeaps, under the ID id / numHeaps, so
+                      //   each heap has room for its share of the IDs only
+  atomic_int size;    // the number of nodes in all heaps
+} MultiQueue;
+
+/* Inserts a node with priority 'priority' and ID 'id' into MultiQueue
+ * 'queue'. If 'queue' holds a node with ID 'id' already, lowers the
+ * priority of that node to 'priority' instead, if it is larger.
+ * Precondition: 0 <= 'id' < queue->capacity
+ *               priority < INT_MAX
+ */
+void multiQueueInsert(MultiQueue* queue, int priority, int id);
+
+/* Removes a node with a small priority from MultiQueue 'queue', stores it in
+ * '*node' and returns true, or returns false if 'queue' is empty. The node
+ * is the minimum of one of two randomly chosen heaps.
+ */
+bool multiQueueExtractMin(MultiQueue* queue, HeapNode* node);
+
+/* Returns the number of nodes in MultiQueue 'queue'. */
+int multiQueueSize(MultiQueue* queue);
+
+/* Returns a newly created empty MultiQueue of 'numHeaps' heaps for nodes with
+ * IDs 0, 1, ..., 'capacity'-1. If 'numHeaps' is not positive, uses two heaps
+ * per online processor.
+ * Precondition: capacity >= 0
+ */
+MultiQueue* newMultiQueue(int capacity, int numHeaps);
+
+/* Frees all memory allocated for MultiQueue 'queue'.
+ */
+void deleteMultiQueue(MultiQueue* queue);
+
+#endif